@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graphic.h"
+#include "pool.h"
+#include "random.h"
+
+/*
+ * Hammers the handle pool and the stores built on it with create/delete/
+ * activate/deactivate sequences, checks the id to index mapping and that
+ * deleted handles are rejected after every operation, and
+ * prints the throughput of an unchecked run as JSON lines. The textures store
+ * deletes a texture, with its sprites, and creates it again per op, so its
+ * line also tells how many sprites that removed per second. Exits with a
+ * failure status on the first broken invariant, e.g.:
+ *
+ *   bin/bench-dod --max 100000 --ops 200000
+ */
+
+#define MAX_ELEMENTS (1 << 20)
+#define TEXTURES 64
+
+static struct {
+  Id* payload;
+  Pool pool;
+} _store;
+
+static Id _live[MAX_ELEMENTS];
+static int _expected[MAX_SPRITES];
+static bool _active[MAX_SPRITES];
+static int _violations;
+static Random_State _random;
+
+static void
+_fail(const char* store, const char* what, Id id)
+{
+  if (_violations++ < 10) {
+    fprintf(stderr, "%s: %s (id %u)\n", store, what, id);
+  }
+}
+
+static double
+_seconds(Uint64 start)
+{
+  return (double) (SDL_GetPerformanceCounter() - start) / 
+    SDL_GetPerformanceFrequency();
+}
+
+static void
+_report(const char* store, int elements, int ops, double seconds)
+{
+  printf(
+    "{\"benchmark\": \"dod\", \"store\": \"%s\", \"elements\": %d, "
+    "\"ops\": %d, \"ops_per_second\": %.0f, \"violations\": %d}\n",
+    store,
+    elements,
+    ops,
+    seconds > 0 ? ops / seconds : 0,
+    _violations
+  );
+}
+
+static void
+_reportTextures(int elements, int ops, long removed, double seconds)
+{
+  printf(
+    "{\"benchmark\": \"dod\", \"store\": \"textures\", \"elements\": %d, "
+    "\"ops\": %d, \"ops_per_second\": %.0f, "
+    "\"sprites_removed_per_second\": %.0f, \"violations\": %d}\n",
+    elements,
+    ops,
+    seconds > 0 ? ops / seconds : 0,
+    seconds > 0 ? removed / seconds : 0,
+    _violations
+  );
+}
+
+static void
+_checkStoreElement(Id id)
+{
+  if (!Pool_Has(&_store.pool, id)) {
+    _fail("pool", "live handle is rejected", id);
+  } else if (_store.payload[Pool_GetIndex(&_store.pool, id)] != id) {
+    _fail("pool", "index holds another element's payload", id);
+  }
+}
+
+static void
+_checkStore()
+{
+  if (!Pool_Check(&_store.pool)) {
+    _fail("pool", "pool invariants are broken", VOID_ID);
+  }
+}
+
+static Id
+_storeCreate()
+{
+  Index index;
+  Id id = Pool_Create(&_store.pool, &index);
+  _store.payload[index] = id;
+  return id;
+}
+
+static void
+_runStore(int elements, int ops, bool verify)
+{
+  Pool_Init(&_store.pool, 1024, MAX_ELEMENTS);
+  POOL_ADD_COLUMN(&_store.pool, _store.payload);
+  Random_Seed(&_random, 0x2545F491, 0);
+
+  Pool_CreateMany(&_store.pool, elements, _live);
+  for (int i = 0; i < elements; i++) {
+    _store.payload[i] = _live[i];
+  }
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < ops; i++) {
+    unsigned int victim = Random_Range(&_random, elements);
+    Id deleted = _live[victim];
+    Id moved = _store.pool.ids[_store.pool.total - 1];
+    Pool_Delete(&_store.pool, deleted);
+    _live[victim] = _storeCreate();
+
+    if (verify) {
+      if (Pool_Has(&_store.pool, deleted)) {
+        _fail("pool", "stale handle is accepted", deleted);
+      }
+      _checkStoreElement(_live[victim]);
+      if (moved != deleted) {
+        _checkStoreElement(moved);
+      }
+      if (i % (ops / 4 + 1) == 0) {
+        _checkStore();
+      }
+    }
+  }
+
+  if (verify) {
+    _checkStore();
+  } else {
+    _report("pool", elements, ops, _seconds(start));
+  }
+
+  Pool_Free(&_store.pool);
+}
+
+static void
+_checkSprite(Id id)
+{
+  SDL_Rect dest;
+  Graphic_QuerySpriteDest(id, &dest);
+  if (dest.x != _expected[id & INDEX_INDEX_MASK]) {
+    _fail("sprites", "id resolves to another sprite", id);
+  }
+  if (Graphic_IsSpriteActive(id) != _active[id & INDEX_INDEX_MASK]) {
+    _fail("sprites", "sprite is in the wrong active partition", id);
+  }
+}
+
+static void
+_checkSprites(int elements)
+{
+  if (!Graphic_CheckSprites()) {
+    _fail("sprites", "store invariants are broken", VOID_ID);
+  }
+  for (int i = 0; i < elements; i++) {
+    _checkSprite(_live[i]);
+  }
+}
+
+static Id
+_spriteCreate(Id texture, int serial)
+{
+  SDL_Rect src = {0, 0, 1, 1};
+  SDL_Rect dest = {serial, 0, 1, 1};
+  Id id = Graphic_CreateTilesetSprite(texture, src, dest);
+  _expected[id & INDEX_INDEX_MASK] = serial;
+  _active[id & INDEX_INDEX_MASK] = true;
+  return id;
+}
+
+static void
+_runSprites(int elements, int ops, bool verify)
+{
+  Graphic_Clear();
+  Graphic_InitCamera();
+  Id texture = Graphic_CreateSolidTexture(0xFFFFFF);
+  Random_Seed(&_random, 0x2545F491, 0);
+
+  int serial = 0;
+  for (int i = 0; i < elements; i++) {
+    _live[i] = _spriteCreate(texture, serial++);
+  }
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < ops; i++) {
+    unsigned int victim = Random_Range(&_random, elements);
+    Id id = _live[victim];
+
+    switch (Random_Range(&_random, 3)) {
+      case 0:
+        Graphic_DeleteSprite(id);
+        _live[victim] = id = _spriteCreate(texture, serial++);
+        break;
+      case 1:
+        Graphic_SetSpriteToInactive(id);
+        _active[id & INDEX_INDEX_MASK] = false;
+        break;
+      case 2:
+        Graphic_SetSpriteToActive(id);
+        _active[id & INDEX_INDEX_MASK] = true;
+        break;
+    }
+
+    if (verify) {
+      _checkSprite(id);
+      _checkSprite(_live[Random_Range(&_random, elements)]);
+      if (i % (ops / 4 + 1) == 0) {
+        _checkSprites(elements);
+      }
+    }
+  }
+
+  if (verify) {
+    _checkSprites(elements);
+  } else {
+    _report("sprites", elements, ops, _seconds(start));
+  }
+}
+
+static void
+_checkSpriteTotal(unsigned long expected)
+{
+  Graphic_ResourceStats stats;
+  Graphic_QueryResources(&stats);
+  if (stats.sprites != expected) {
+    _fail("textures", "texture deletion left the wrong sprites", VOID_ID);
+  }
+}
+
+static void
+_runTextures(int elements, int ops, bool verify)
+{
+  Graphic_Clear();
+  Graphic_InitCamera();
+  Random_Seed(&_random, 0x2545F491, 0);
+
+  // The sprites of texture t are members[starts[t]] up to members[starts[t + 1]].
+  static int members[MAX_ELEMENTS];
+  int starts[TEXTURES + 1] = {0};
+  Id textures[TEXTURES];
+  static int owner[MAX_ELEMENTS];
+
+  for (int t = 0; t < TEXTURES; t++) {
+    textures[t] = Graphic_CreateSolidTexture(t);
+  }
+  int serial = 0;
+  for (int i = 0; i < elements; i++) {
+    owner[i] = Random_Range(&_random, TEXTURES);
+    starts[owner[i] + 1]++;
+    _live[i] = _spriteCreate(textures[owner[i]], serial++);
+    if (Random_Range(&_random, 2)) {
+      Graphic_SetSpriteToInactive(_live[i]);
+      _active[_live[i] & INDEX_INDEX_MASK] = false;
+    }
+  }
+  for (int t = 0; t < TEXTURES; t++) {
+    starts[t + 1] += starts[t];
+  }
+  int filled[TEXTURES];
+  memcpy(filled, starts, sizeof(filled));
+  for (int i = 0; i < elements; i++) {
+    members[filled[owner[i]]++] = i;
+  }
+
+  // Each op removes elements / TEXTURES sprites on average, ops in all.
+  int churns = SDL_max(1, (int) ((long long) ops * TEXTURES / elements));
+  long removed = 0;
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int c = 0; c < churns; c++) {
+    int t = Random_Range(&_random, TEXTURES);
+    Graphic_DeleteTexture(textures[t]);
+    if (verify) {
+      _checkSpriteTotal(elements - (starts[t + 1] - starts[t]));
+    }
+
+    textures[t] = Graphic_CreateSolidTexture(c);
+    for (int m = starts[t]; m < starts[t + 1]; m++) {
+      _live[members[m]] = _spriteCreate(textures[t], serial++);
+    }
+    removed += starts[t + 1] - starts[t];
+
+    if (verify) {
+      _checkSpriteTotal(elements);
+      _checkSprite(_live[Random_Range(&_random, elements)]);
+      if (c % (churns / 4 + 1) == 0) {
+        _checkSprites(elements);
+      }
+    }
+  }
+
+  if (verify) {
+    _checkSprites(elements);
+  } else {
+    _reportTextures(elements, churns, removed, _seconds(start));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  int max = 1000000;
+  int ops = 1000000;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--max") && i + 1 < argc) {
+      max = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--ops") && i + 1 < argc) {
+      ops = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [--max N] [--ops K]\n", argv[0]);
+      return(EXIT_FAILURE);
+    }
+  }
+
+  if (max > MAX_SPRITES - 2) {
+    max = MAX_SPRITES - 2;
+  }
+
+  if (!Graphic_Init("Lemonade 5000", 1280, 720, 24, Graphic_NullBackend)) {
+    return(EXIT_FAILURE);
+  }
+
+  for (int elements = 1000; elements <= max; elements *= 10) {
+    _runStore(elements, ops, true);
+    _runStore(elements, ops, false);
+    _runSprites(elements, ops, true);
+    _runSprites(elements, ops, false);
+    _runTextures(elements, ops, true);
+    _runTextures(elements, ops, false);
+  }
+
+  Graphic_Quit();
+
+  return(_violations ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,312 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graphic.h"
+#include "random.h"
+#include "widget.h"
+
+/*
+ * Renders scripted camera pans and zooms over N tileset sprites on the
+ * software backend and prints one JSON object per scenario. The tile-layer
+ * scenario draws the same count as tiles of a chunked layer instead, under a
+ * small chunk budget so eviction and rebakes show up. The all-visible
+ * scenario keeps the camera still and fails if any sprite is culled, e.g.:
+ *
+ *   bin/bench-render --sprites 20000 --frames 300 --scenario mostly-culled
+ *
+ * The texture-load scenario times loading the tileset, uploaded from the
+ * asset pack given with --pack or decoded without it. The widget scenarios
+ * render a panel of widgets that either stays the same or has one widget
+ * shown or hidden every frame.
+ */
+
+#define WINDOW_WIDTH 1280
+#define WINDOW_HEIGHT 720
+#define TILESET "sprite-sheet2.bmp"
+#define MANY_TEXTURES 32
+#define TILE_WIDTH 32
+#define TILE_HEIGHT 16
+#define CHUNK_BUDGET (4 * 1024 * 1024)
+#define WIDGETS 200
+
+typedef struct {
+  const char* name;
+  int textures;
+  double visible;
+  bool tileLayer;
+  bool still;
+} Scenario;
+
+static const Scenario _scenarios[] = {
+  { "all-visible", 1, 1.0, false, true },
+  { "mostly-culled", 1, 0.05, false, false },
+  { "single-texture", 1, 1.0, false, false },
+  { "many-texture", MANY_TEXTURES, 1.0, false, false },
+  { "tile-layer", 1, 1.0, true, false },
+};
+
+static void
+_createSprites(const Scenario* scenario, int count)
+{
+  Id textures[MANY_TEXTURES];
+  for (int i = 0; i < scenario->textures; i++) {
+    textures[i] = Graphic_LoadTexture(TILESET);
+  }
+
+  Random_State random;
+  Random_Seed(&random, 1, 0);
+  for (int i = 0; i < count; i++) {
+    SDL_Rect src, dest;
+    if (!strcmp(scenario->name, "single-texture")) {
+      src.x = 0;
+      src.y = 12 * TILE_HEIGHT;
+    } else {
+      src.x = Random_Range(&random, 8) * TILE_WIDTH;
+      src.y = Random_Range(&random, 30) * TILE_HEIGHT;
+    }
+    src.w = TILE_WIDTH;
+    src.h = TILE_HEIGHT;
+
+    dest.w = TILE_WIDTH;
+    dest.h = TILE_HEIGHT;
+    dest.x = Random_Range(&random, WINDOW_WIDTH - TILE_WIDTH);
+    dest.y = Random_Range(&random, WINDOW_HEIGHT - TILE_HEIGHT);
+    if (Random_NextDouble(&random) >= scenario->visible) {
+      // Far enough that panning never brings it into view.
+      dest.x += 16 * WINDOW_WIDTH;
+      dest.y += 16 * WINDOW_HEIGHT;
+    }
+
+    Graphic_CreateTilesetSprite(textures[i % scenario->textures], src, dest);
+  }
+}
+
+static void
+_createTileLayer(int count)
+{
+  Id texture = Graphic_LoadTexture(TILESET);
+  SDL_Rect palette[8];
+  for (int i = 0; i < 8; i++) {
+    palette[i].x = i * TILE_WIDTH;
+    palette[i].y = 12 * TILE_HEIGHT;
+    palette[i].w = TILE_WIDTH;
+    palette[i].h = TILE_HEIGHT;
+  }
+
+  int side = sqrt(count);
+  Id layer = Graphic_CreateTileLayer(
+    texture, 
+    Graphic_IsometricTiles, 
+    side, 
+    side, 
+    TILE_WIDTH, 
+    TILE_HEIGHT, 
+    palette, 
+    8
+  );
+
+  Random_State random;
+  Random_Seed(&random, 1, 0);
+  for (int y = 0; y < side; y++) {
+    for (int x = 0; x < side; x++) {
+      Graphic_SetTileLayerTile(layer, x, y, Random_Range(&random, 8));
+    }
+  }
+  Graphic_SetTileLayerBudget(CHUNK_BUDGET);
+}
+
+static void
+_moveCamera(int frame, double* zoom)
+{
+  int phase = frame / 50 % 4;
+  int dx = phase == 0 ? 4 : phase == 2 ? -4 : 0;
+  int dy = phase == 1 ? 4 : phase == 3 ? -4 : 0;
+  Graphic_MoveCamera(dx, dy);
+
+  if (frame % 100 == 99) {
+    if (*zoom < 3) {
+      Graphic_ZoomSprites((*zoom + 1.0) / *zoom);
+      *zoom += 1.0;
+    } else {
+      Graphic_ZoomSprites(1.0 / *zoom);
+      *zoom = 1.0;
+    }
+  }
+}
+
+static void
+_measureTextureLoads(bool packed)
+{
+  Graphic_Clear();
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < MANY_TEXTURES; i++) {
+    Graphic_LoadTexture(TILESET);
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+  double ms = (double) (end - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+  printf(
+    "{\"benchmark\": \"render\", \"scenario\": \"texture-load\", "
+    "\"textures\": %d, \"packed\": %s, \"ms_per_texture\": %.4f}\n",
+    MANY_TEXTURES,
+    packed ? "true" : "false",
+    ms / MANY_TEXTURES
+  );
+}
+
+static void
+_measureWidgets(bool changing, int frames)
+{
+  Graphic_Clear();
+  Widget_OpenScope();
+  Id panel = Widget_Create(VOID_ID);
+  Widget_SetPosition(panel, 0, 0, 50, 50, UnitInPercentFlags_Width);
+  Id widgets[WIDGETS];
+  SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+  for (int i = 0; i < WIDGETS; i++) {
+    widgets[i] = Widget_Create(panel);
+    Widget_SetPosition(widgets[i], i % 20 * 10, i / 20 * 10, 8, 8, 0);
+    if (i % 4 == 0) {
+      Widget_SetText(widgets[i], "Lemonade", white);
+    }
+  }
+  Graphic_ResetRenderStats();
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < frames; frame++) {
+    if (changing) {
+      Widget_SetHidden(widgets[frame % WIDGETS], frame / WIDGETS % 2 == 0);
+    }
+    Graphic_Render();
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+  Widget_CloseScope();
+
+  Graphic_RenderStats stats;
+  Graphic_QueryRenderStats(&stats);
+  double ms = (double) (end - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+  printf(
+    "{\"benchmark\": \"render\", \"scenario\": \"%s\", \"widgets\": %d, "
+    "\"frames\": %lu, \"ms_per_frame\": %.4f, \"draw_calls_per_frame\": %.2f}\n",
+    changing ? "widgets-changing" : "widgets-static",
+    WIDGETS + 1,
+    stats.frames,
+    stats.frames ? ms / stats.frames : 0,
+    stats.frames ? (double) stats.drawCalls / stats.frames : 0
+  );
+}
+
+static bool
+_runScenario(const Scenario* scenario, int sprites, int frames)
+{
+  Graphic_Clear();
+  Graphic_InitCamera();
+  if (scenario->tileLayer) {
+    _createTileLayer(sprites);
+  } else {
+    _createSprites(scenario, sprites);
+  }
+  Graphic_ResetRenderStats();
+
+  double zoom = 1.0;
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int frame = 0; frame < frames; frame++) {
+    if (!scenario->still) {
+      _moveCamera(frame, &zoom);
+    }
+    Graphic_Render();
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+
+  Graphic_RenderStats stats;
+  Graphic_QueryRenderStats(&stats);
+  double ms = (double) (end - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+  printf(
+    "{\"benchmark\": \"render\", \"scenario\": \"%s\", \"sprites\": %d, "
+    "\"frames\": %lu, \"ms_per_frame\": %.4f, \"sprites_per_ms\": %.2f, "
+    "\"draw_calls_per_frame\": %.2f, \"culled_per_frame\": %.2f, "
+    "\"chunks_per_frame\": %.2f, \"bakes\": %lu}\n",
+    scenario->name,
+    sprites,
+    stats.frames,
+    stats.frames ? ms / stats.frames : 0,
+    ms > 0 ? (double) (stats.sprites + stats.chunks + stats.culled) / ms : 0,
+    stats.frames ? (double) stats.drawCalls / stats.frames : 0,
+    stats.frames ? (double) stats.culled / stats.frames : 0,
+    stats.frames ? (double) stats.chunks / stats.frames : 0,
+    stats.bakes
+  );
+
+  if (scenario->still && stats.culled > 0) {
+    fprintf(stderr, "%s culled %lu sprites!\n", scenario->name, stats.culled);
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char** argv)
+{
+  int sprites = 10000;
+  int frames = 300;
+  const char* only = NULL;
+  const char* pack = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--sprites") && i + 1 < argc) {
+      sprites = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--scenario") && i + 1 < argc) {
+      only = argv[++i];
+    } else if (!strcmp(argv[i], "--pack") && i + 1 < argc) {
+      pack = argv[++i];
+    } else {
+      fprintf(
+        stderr, 
+        "usage: %s [--sprites N] [--frames F] [--scenario NAME] [--pack FILE]\n", 
+        argv[0]
+      );
+      return(EXIT_FAILURE);
+    }
+  }
+
+  if (!Graphic_Init(
+        "Lemonade 5000", 
+        WINDOW_WIDTH, 
+        WINDOW_HEIGHT, 
+        24, 
+        Graphic_SoftwareBackend)) {
+    return(EXIT_FAILURE);
+  }
+  if (pack && !Graphic_OpenPack(pack)) {
+    return(EXIT_FAILURE);
+  }
+  Widget_Init();
+
+  if (!only || !strcmp(only, "texture-load")) {
+    _measureTextureLoads(pack != NULL);
+  }
+  for (unsigned int i = 0; i < ARRAY_LENGTH(_scenarios); i++) {
+    if (!only || !strcmp(only, _scenarios[i].name)) {
+      if (!_runScenario(&_scenarios[i], sprites, frames)) {
+        Graphic_Quit();
+        return(EXIT_FAILURE);
+      }
+    }
+  }
+  if (!only || !strcmp(only, "widgets-static")) {
+    _measureWidgets(false, frames);
+  }
+  if (!only || !strcmp(only, "widgets-changing")) {
+    _measureWidgets(true, frames);
+  }
+
+  Graphic_Quit();
+
+  return(EXIT_SUCCESS);
+}
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "graphic.h"
+#include "game.h"
+#include "main-menu.h"
+#include "save.h"
+#include "scene.h"
+#include "widget.h"
+
+/*
+ * Goes back and forth between the main menu and the game on the null
+ * graphic backend, entering the level and loading a save in turn, and
+ * prints the resources left alive as one JSON object, e.g.:
+ *
+ *   bin/bench-scenes --transitions 500 --level levels/city.lvl
+ *
+ * Fails when there are more textures, sprites, clips, tile layers or widgets
+ * after the last transition than after the first few, or when the peak
+ * memory grew by more than MEMORY_TOLERANCE_KB, since every scene releases
+ * what it created when popped.
+ */
+
+#define WARM_UP_TRANSITIONS 4
+#define MEMORY_TOLERANCE_KB 1024
+
+typedef struct {
+  Graphic_ResourceStats graphic;
+  Index widgets;
+  long peakMemoryKb;
+} _Resources;
+
+static long
+_peakMemoryKb()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+static void
+_play(int updates)
+{
+  for (int i = 0; i < updates; i++) {
+    Scene_GetCurrent()->update();
+    Graphic_Render();
+  }
+}
+
+static bool
+_transition(int i, const char* save)
+{
+  const Scene* menu = Scene_GetCurrent();
+  if (i % 2 == 0) {
+    Game_Enter();
+    Scene_FinishLoading();
+  } else if (!Game_Load(save)) {
+    return false;
+  }
+  if (Scene_GetCurrent() == menu) {
+    fprintf(stderr, "Transition %d didn't leave the menu!\n", i);
+    return false;
+  }
+
+  _play(4);
+  // The menu spawns its customers again, at the same places every time.
+  Game_Seed(1);
+  Scene_Pop();
+  return true;
+}
+
+static void
+_queryResources(_Resources* resources)
+{
+  Graphic_QueryResources(&resources->graphic);
+  resources->widgets = Widget_GetTotal();
+  resources->peakMemoryKb = _peakMemoryKb();
+}
+
+static bool
+_hasGrown(const _Resources* before, const _Resources* after)
+{
+  return after->graphic.textures > before->graphic.textures
+    || after->graphic.sprites > before->graphic.sprites
+    || after->graphic.clips > before->graphic.clips
+    || after->graphic.tileLayers > before->graphic.tileLayers
+    || after->widgets > before->widgets
+    || after->peakMemoryKb > before->peakMemoryKb + MEMORY_TOLERANCE_KB;
+}
+
+int
+main(int argc, char** argv)
+{
+  int transitions = 200;
+  const char* level = NULL;
+  const char* save = "bench-scenes.sav";
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--transitions") && i + 1 < argc) {
+      transitions = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--level") && i + 1 < argc) {
+      level = argv[++i];
+    } else if (!strcmp(argv[i], "--save") && i + 1 < argc) {
+      save = argv[++i];
+    } else {
+      fprintf(
+        stderr,
+        "usage: %s [--transitions N] [--level FILE] [--save FILE]\n",
+        argv[0]
+      );
+      return(EXIT_FAILURE);
+    }
+  }
+  if (transitions <= WARM_UP_TRANSITIONS) {
+    transitions = WARM_UP_TRANSITIONS + 1;
+  }
+
+#ifdef __GLIBC__
+  // Otherwise the loader thread gets its own heap and freed textures raise
+  // the mmap threshold, growing the peak memory for many transitions after
+  // the warm-up without anything leaking.
+  mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+  mallopt(M_ARENA_MAX, 1);
+#endif
+
+  if (!Graphic_Init("Lemonade 5000", 1280, 720, 24, Graphic_NullBackend)) {
+    return(EXIT_FAILURE);
+  }
+
+  Graphic_InitCamera();
+  Widget_Init();
+  if (level) {
+    Game_SetLevel(level);
+  }
+  MainMenu_Enter();
+
+  // The save comes from the game the menu runs behind it.
+  Game_Save(save);
+  Save_Wait();
+
+  _Resources warm, last;
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < transitions; i++) {
+    if (!_transition(i, save)) {
+      remove(save);
+      return(EXIT_FAILURE);
+    }
+    if (i + 1 == WARM_UP_TRANSITIONS) {
+      _queryResources(&warm);
+    }
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+  _queryResources(&last);
+  remove(save);
+
+  double ms = (double) (end - start) * 1e3 / SDL_GetPerformanceFrequency();
+  printf(
+    "{\"benchmark\": \"scenes\", \"transitions\": %d, "
+    "\"ms_per_transition\": %.3f, \"textures\": %lu, \"sprites\": %lu, "
+    "\"clips\": %lu, \"tile_layers\": %lu, \"widgets\": %lu, "
+    "\"warm_textures\": %lu, \"warm_sprites\": %lu, \"warm_widgets\": %lu, "
+    "\"warm_peak_memory_kb\": %ld, \"peak_memory_kb\": %ld}\n",
+    transitions,
+    ms / transitions,
+    last.graphic.textures,
+    last.graphic.sprites,
+    last.graphic.clips,
+    last.graphic.tileLayers,
+    (unsigned long) last.widgets,
+    warm.graphic.textures,
+    warm.graphic.sprites,
+    (unsigned long) warm.widgets,
+    warm.peakMemoryKb,
+    last.peakMemoryKb
+  );
+
+  Graphic_Quit();
+
+  if (_hasGrown(&warm, &last)) {
+    fprintf(stderr, "Resources grew across scene transitions!\n");
+    return(EXIT_FAILURE);
+  }
+  return(EXIT_SUCCESS);
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "graphic.h"
+#include "game.h"
+#include "save.h"
+
+/*
+ * Runs the simulation headless on the null graphic backend and prints the
+ * result as one JSON object, e.g.:
+ *
+ *   bin/bench-sim --ticks 10000 --customers 500 --level levels/stress.lvl
+ *
+ * With --save, the simulation is then saved to FILE and loaded back, to
+ * time the copy done on the main thread, the whole write and the restore.
+ */
+
+static double
+_getMs(Uint64 start, Uint64 end)
+{
+  return (double) (end - start) * 1e3 / SDL_GetPerformanceFrequency();
+}
+
+static long
+_peakMemoryKb()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+int
+main(int argc, char** argv) 
+{
+  int ticks = 10000;
+  int customers = 100;
+  unsigned long long seed = 1;
+  const char* level = NULL;
+  const char* save = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--ticks") && i + 1 < argc) {
+      ticks = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--customers") && i + 1 < argc) {
+      customers = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--level") && i + 1 < argc) {
+      level = argv[++i];
+    } else if (!strcmp(argv[i], "--save") && i + 1 < argc) {
+      save = argv[++i];
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else {
+      fprintf(
+        stderr, 
+        "usage: %s [--ticks N] [--customers M] [--level FILE] [--seed S] "
+        "[--save FILE]\n", 
+        argv[0]
+      );
+      return(EXIT_FAILURE);
+    }
+  }
+
+  if (!Graphic_Init("Lemonade 5000", 1280, 720, 24, Graphic_NullBackend)) {
+    return(EXIT_FAILURE);
+  }
+
+  Graphic_InitCamera();
+  Game_Seed(seed);
+  if (level) {
+    Game_SetLevel(level);
+  }
+  Uint64 loadStart = SDL_GetPerformanceCounter();
+  Game_StartSimulation();
+  Uint64 loadEnd = SDL_GetPerformanceCounter();
+  Game_SpawnCustomers(customers);
+  int actors = Game_CountActors();
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (int i = 0; i < ticks; i++) {
+    Game_UpdateSimulation();
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+  int sprites = Game_CountSprites();
+
+  double seconds = (double) (end - start) / SDL_GetPerformanceFrequency();
+  double ns = seconds * 1e9;
+
+  double saveMs = 0, saveWriteMs = 0, restoreMs = 0;
+  if (save) {
+    Uint64 saveStart = SDL_GetPerformanceCounter();
+    Game_Save(save);
+    Uint64 saveEnd = SDL_GetPerformanceCounter();
+    Save_Wait();
+    Uint64 writeEnd = SDL_GetPerformanceCounter();
+    if (!Game_Load(save)) {
+      return(EXIT_FAILURE);
+    }
+    Uint64 restoreEnd = SDL_GetPerformanceCounter();
+    if (Game_CountActors() != actors) {
+      fprintf(stderr, "Restored %d actors out of %d!\n", Game_CountActors(), actors);
+      return(EXIT_FAILURE);
+    }
+
+    saveMs = _getMs(saveStart, saveEnd);
+    saveWriteMs = _getMs(saveStart, writeEnd);
+    restoreMs = _getMs(writeEnd, restoreEnd);
+  }
+
+  printf(
+    "{\"benchmark\": \"sim\", \"ticks\": %d, \"customers\": %d, "
+    "\"actors\": %d, \"sprites\": %d, \"seconds\": %.6f, \"ticks_per_second\": %.2f, "
+    "\"ns_per_actor_tick\": %.2f, \"load_ms\": %.3f, \"save_ms\": %.3f, "
+    "\"save_write_ms\": %.3f, \"restore_ms\": %.3f, "
+    "\"peak_memory_kb\": %ld}\n",
+    ticks,
+    customers,
+    actors,
+    sprites,
+    seconds,
+    seconds > 0 ? ticks / seconds : 0,
+    ticks && actors ? ns / ((double) ticks * actors) : 0,
+    _getMs(loadStart, loadEnd),
+    saveMs,
+    saveWriteMs,
+    restoreMs,
+    _peakMemoryKb()
+  );
+
+  Graphic_Quit();
+
+  return(EXIT_SUCCESS);
+}
@@ -0,0 +1,42 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Linear bump allocator for transient data. Allocations are never freed
+ * one by one: take a mark, allocate, then reset back to the mark (or to
+ * empty) to drop everything allocated since. Running out of space is a
+ * sizing bug and exits.
+ *
+ * The frame arena is reset at the start of every frame, for scratch that
+ * doesn't outlive the function that took it.
+ */
+
+typedef struct {
+  char* data;
+  size_t size;
+  size_t used;
+  size_t peak;
+  const char* name;
+} Arena;
+
+typedef size_t Arena_Mark;
+
+#define ARENA_ALLOC_ARRAY(arena, type, count) \
+  ((type*) Arena_Alloc(arena, sizeof(type) * (count), _Alignof(type)))
+
+void Arena_Init(Arena* arena, const char* name, size_t size);
+void Arena_Free(Arena* arena);
+
+void* Arena_Alloc(Arena* arena, size_t size, size_t alignment);
+void* Arena_AllocZeroed(Arena* arena, size_t size, size_t alignment);
+
+Arena_Mark Arena_GetMark(const Arena* arena);
+void Arena_ResetTo(Arena* arena, Arena_Mark mark);
+void Arena_Reset(Arena* arena);
+
+Arena* Arena_GetFrame();
+void Arena_Quit();
+
+#endif
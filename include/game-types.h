@@ -0,0 +1,114 @@
+#ifndef GAME_TYPES_H
+#define GAME_TYPES_H
+
+/*
+ * Tiles, paths and lanes shared by the game, the level loader and the level
+ * compiler. Each list expands X(name) once per value, in value order, so
+ * the enums and their name tables can't drift apart.
+ */
+
+#define GAME_TILES(X) \
+  X(Empty) \
+  X(Grass) \
+  X(SideWalk) \
+  X(CrosswalkNorthSouth1) \
+  X(CrosswalkNorthSouth2) \
+  X(CrosswalkEastWest1) \
+  X(CrosswalkEastWest2) \
+  X(Road) \
+  X(Stand) \
+  X(StandingCharacterSouth) \
+  X(StandingCharacterEast) \
+  X(StandingCharacterNorth) \
+  X(StandingCharacterWest) \
+  X(WalkingCharacterSouth1) \
+  X(WalkingCharacterEast1) \
+  X(WalkingCharacterNorth1) \
+  X(WalkingCharacterWest1) \
+  X(WalkingCharacterSouth2) \
+  X(WalkingCharacterEast2) \
+  X(WalkingCharacterNorth2) \
+  X(WalkingCharacterWest2) \
+  X(StopSignFacingEast) \
+  X(StopSignFacingSouth) \
+  X(StopSignFacingWest) \
+  X(StopSignFacingNorth) \
+  X(Bush) \
+  X(LeftHouseCorner) \
+  X(HouseDoor) \
+  X(Wall) \
+  X(RightHouseCorner) \
+  X(HouseRightWallFirstSection) \
+  X(HouseRightWallCenterSection) \
+  X(HouseRightWallThirdSection) \
+  X(HouseRightWallLastSection) \
+  X(HouseRoof) \
+  X(HouseLeftRoof) \
+  X(HouseTopRoof) \
+  X(HouseTopLeftRoof) \
+  X(FrontPorchStair) \
+  X(NorthToSouthEntryWalkway) \
+  X(EastToWestFence) \
+  X(SouthToNorthFence) \
+  X(EastToWestFenceEntrance) \
+  X(WestToNorthFenceCorner) \
+  X(NorthToSouthFence) \
+  X(EastToNorthFenceCorner)
+
+#define GAME_PATHS(X) \
+  X(NoPath) \
+  X(SouthToNorthOnWestSide) \
+  X(NorthToSouthOnWestSide) \
+  X(SouthToNorthOnEastSide) \
+  X(NorthToSouthOnEastSide) \
+  X(SouthOnWestSideToWestOnSouthSide) \
+  X(WestOnSouthSideToSouthOnWestSide) \
+  X(SouthOnEastSideToWestOnSouthSide) \
+  X(WestOnSouthSideToSouthOnEastSide) \
+  X(NorthOnWestSideToWestOnSouthSide) \
+  X(WestOnSouthSideToNorthOnWestSide) \
+  X(NorthOnEastSideToWestOnSouthSide) \
+  X(WestOnSouthSideToNorthOnEastSide) \
+  X(SouthOnWestSideToWestOnNorthSide) \
+  X(WestOnNorthSideToSouthOnWestSide) \
+  X(SouthOnEastSideToWestOnNorthSide) \
+  X(WestOnNorthSideToSouthOnEastSide) \
+  X(NorthOnWestSideToWestOnNorthSide) \
+  X(WestOnNorthSideToNorthOnWestSide) \
+  X(NorthOnEastSideToWestOnNorthSide) \
+  X(WestOnNorthSideToNorthOnEastSide)
+
+#define GAME_LANES(X) \
+  X(NorthToSouthWestSide) \
+  X(SouthToNorthWestSide) \
+  X(NorthToSouthEastSide) \
+  X(SouthToNorthEastSide) \
+  X(EastToWestNorthSide) \
+  X(WestToEastNorthSide) \
+  X(EastToWestSouthSide) \
+  X(WestToEastSouthSide)
+
+#define GAME_TYPES_ENUM_TILE(name) GameTile_##name,
+#define GAME_TYPES_ENUM_VALUE(name) name,
+#define GAME_TYPES_ENUM_LANE(name) Lane_##name,
+#define GAME_TYPES_NAME(name) #name,
+#define GAME_TYPES_COUNT(name) + 1
+
+typedef enum {
+  GAME_TILES(GAME_TYPES_ENUM_TILE)
+  TotalGameTiles,
+} GameTiles;
+
+typedef enum {
+  GAME_PATHS(GAME_TYPES_ENUM_VALUE)
+} Path;
+
+// Kept out of Path so switches over paths don't have to handle it.
+enum { TotalPaths = 0 GAME_PATHS(GAME_TYPES_COUNT) };
+
+typedef enum {
+  GAME_LANES(GAME_TYPES_ENUM_LANE)
+  TotalLanes,
+} Lane;
+
+#endif
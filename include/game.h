@@ -1,8 +1,25 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <stdbool.h>
+
+#define GAME_SAVE_FILE "lemonade.sav"
+
 void Game_Enter();
 void Game_StartSimulation();
 void Game_UpdateSimulation();
+void Game_SetLevel(const char* filename);
+/*
+ * Saving copies the game's state and writes it in the background. Loading
+ * replaces the current scene with the saved game, and leaves everything as
+ * is when the save can't be read.
+ */
+void Game_Save(const char* filename);
+bool Game_Load(const char* filename);
+void Game_Seed(unsigned long long seed);
+void Game_SpawnCustomers(int count);
+int Game_CountActors();
+/* Actors only have a sprite while they are near the screen. */
+int Game_CountSprites();
 
 #endif
@@ -22,13 +22,75 @@ typedef struct {
   Id textureId;
 } Sprite;
 
-bool Graphic_Init(const char * const title, int w, int h, int font_size);
+typedef enum {
+  Graphic_HardwareBackend,
+  Graphic_SoftwareBackend,
+  Graphic_NullBackend,
+} Graphic_Backend;
+
+typedef enum {
+  Graphic_OrthogonalTiles,
+  Graphic_IsometricTiles,
+} Graphic_TileProjection;
+
+/*
+ * Sprites are drawn layer by layer, in this order, after the tile layers.
+ * The camera only moves and zooms the world layers; screen sprites are
+ * placed in window coordinates and stay where they are put.
+ */
+typedef enum {
+  Graphic_WorldLayer,
+  Graphic_WorldOverlayLayer,
+  Graphic_ScreenLayer,
+  Graphic_TotalLayers,
+} Graphic_Layer;
+
+typedef struct {
+  unsigned long frames;
+  unsigned long sprites;
+  unsigned long chunks;
+  unsigned long bakes;
+  unsigned long culled;
+  unsigned long drawCalls;
+} Graphic_RenderStats;
+
+/* How many of each resource are alive. */
+typedef struct {
+  unsigned long textures;
+  unsigned long sprites;
+  unsigned long clips;
+  unsigned long tileLayers;
+} Graphic_ResourceStats;
+
+bool Graphic_Init(
+  const char * const title, 
+  int w, 
+  int h, 
+  int font_size,
+  Graphic_Backend backend
+);
 
 void Graphic_Quit();
 void Graphic_Render();
+void Graphic_QueryRenderStats(Graphic_RenderStats* stats);
+void Graphic_ResetRenderStats();
+void Graphic_QueryResources(Graphic_ResourceStats* stats);
+/* Waits for the texture if it is still being decoded. */
 void Graphic_QueryTextureSize(Id texture_id, int* w, int* h);
+/* The size is cached, so it is cheap enough to query every update. */
 void Graphic_QueryWindowSize(int* w, int* h);
+/* Called by Input_PollInputs when the window gets resized. */
+void Graphic_ResizeWindow(int w, int h);
 void Graphic_Clear();
+/*
+ * Textures, sprites, clips and tile layers belong to the innermost scope
+ * open when they are created. Closing it deletes whatever is left of them
+ * in one pass, with the textures of text sprites. Scenes open one each.
+ */
+void Graphic_OpenScope();
+void Graphic_CloseScope();
+/* Moves a texture loaded ahead of time into the innermost scope. */
+void Graphic_AdoptTexture(Id id);
 void Graphic_TranslateAllSprite(int dx, int dy);
 void Graphic_TranslateSprite(Id id, int x, int y);
 void Graphic_TranslateSpriteFloat(
@@ -62,11 +124,31 @@ void Graphic_SetSpriteSrcRect(Id id, SDL_Rect src);
 void Graphic_SetPosition(Id id, int x, int y);
 void Graphic_SetSpriteToInactive(Id id);
 void Graphic_SetSpriteToActive(Id id);
+bool Graphic_IsSpriteActive(Id id);
+bool Graphic_CheckSprites();
+/* Sprites are created in this layer from then on, the world's by default. */
+void Graphic_SetLayer(Graphic_Layer layer);
 void Graphic_SetSpriteDest(Id id, SDL_Rect dest);
 void Graphic_CenterSpriteInRect(Id id, SDL_Rect rect);
 void Graphic_CenterSpriteInRectButKeepRatio(Id id, SDL_Rect rect);
 
+/*
+ * Maps an asset pack made by tools/asset-packer. Textures loaded afterwards
+ * by the name of an image in the pack are uploaded from it rather than
+ * decoded. Returns false, and keeps decoding images, when it can't be read.
+ */
+bool Graphic_OpenPack(const char* const filename);
 Id Graphic_LoadTexture(const char* const filename);
+/*
+ * Returns at once with a transparent 1x1 placeholder while worker threads
+ * decode the image. It is uploaded by the next Graphic_Render, and sprites
+ * made from the placeholder then show the image: those that showed all of
+ * it show all of the image. Baking sprites waits for their textures.
+ */
+Id Graphic_LoadTextureAsync(const char* const filename);
+bool Graphic_IsTextureLoaded(Id id);
+/* Blocks until the texture is decoded and uploads it. */
+void Graphic_WaitTexture(Id id);
 Id Graphic_CreateTilesetSprite(Id texture_id, SDL_Rect src, SDL_Rect dest);
 Id Graphic_CreateFullTextureSprite(Id texture_id, SDL_Rect dest); 
 Id Graphic_CreateText(const char * const text, int x, int y, SDL_Color color);
@@ -76,6 +158,63 @@ Id Graphic_CreateTextTexture(const char * const text, SDL_Color color);
 Id Graphic_CreateInactiveSprite(Id textureId);
 Id Graphic_CreateInactiveText(char * const text, SDL_Color color);
 Id Graphic_CreateSpriteFromSprites(Sprite *start, Sprite *end);
+/*
+ * Bakes the sprites into a new texture the size of their union, which is
+ * returned in bounds, so one baked texture can back many sprites.
+ */
+Id Graphic_CreateTextureFromSprites(
+  const Sprite* start, 
+  const Sprite* end, 
+  SDL_Rect* bounds
+);
+
+/*
+ * Tile layers draw a static grid of tiles below every sprite. The grid is
+ * split into chunks of 16x16 tiles, each baked to its own texture the first
+ * time it becomes visible and rebaked only after one of its tiles changed.
+ * Baked chunks that have been off-screen the longest are evicted once the
+ * baked textures exceed the budget.
+ *
+ * A tile is an index in the palette of source rects given at creation, or
+ * VOID_SMALL_ID for no tile. Tiles taller than the grid cell grow upwards.
+ */
+Id Graphic_CreateTileLayer(
+  Id textureId,
+  Graphic_TileProjection projection,
+  int width,
+  int height,
+  int tileWidth,
+  int tileHeight,
+  const SDL_Rect* palette,
+  int paletteSize
+);
+void Graphic_DeleteTileLayer(Id id);
+void Graphic_SetTileLayerTile(Id id, int x, int y, SmallId tile);
+/* Sets a w by h rect of tiles, read pitch tiles apart from row to row. */
+void Graphic_SetTileLayerTiles(
+  Id id, 
+  int x, 
+  int y, 
+  int w, 
+  int h, 
+  const SmallId* tiles, 
+  int pitch
+);
+SmallId Graphic_GetTileLayerTile(Id id, int x, int y);
+void Graphic_SetTileLayerBudget(size_t bytes);
+
+/*
+ * Clips are lists of source rects a sprite cycles through, each shown for
+ * frameTicks calls of Graphic_AnimateSprites. Playing the clip a sprite is
+ * already playing keeps its current frame.
+ */
+Id Graphic_CreateClip(const SDL_Rect* frames, int totalFrames, int frameTicks);
+void Graphic_PlayClip(Id sprite, Id clip);
+void Graphic_StopClip(Id sprite);
+/* No sprite may still be playing it. */
+void Graphic_DeleteClip(Id clip);
+/* Advances every sprite playing a clip by one tick. */
+void Graphic_AnimateSprites();
 
 SDL_Texture* Graphic_CreateSDLTexture(const char* const filename);
 SDL_Texture* Graphic_CreateTextSDLTexture(
@@ -86,8 +225,18 @@ SDL_Texture* Graphic_CreateTextSDLTexture(
 );
 
 void Graphic_RenderCopy(SDL_Texture* texture, SDL_Rect* src, SDL_Rect* dest);
+/*
+ * Texture that draw calls can be redirected to, then drawn in one copy.
+ * Returns NULL when the renderer can't render to textures.
+ */
+SDL_Texture* Graphic_CreateTargetSDLTexture(int w, int h);
+/* Draws into target, cleared to transparent first, until Graphic_EndTarget. */
+void Graphic_BeginTarget(SDL_Texture* target);
+void Graphic_EndTarget();
 
 double Graphic_GetCameraZoom();
+/* Rect of the world, in the coordinates sprites are created with, on screen. */
+void Graphic_QueryCameraView(SDL_Rect* view);
 void Graphic_FillRect(SDL_Rect dest, Uint32 color);
 void Graphic_QuerySDLTextureSize(SDL_Texture* texture, int* w, int* h);
 
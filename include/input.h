@@ -15,6 +15,13 @@ void Input_PollInputs();
 bool Input_IsKeyPressed(SDL_Keycode code);
 bool Input_IsKeyReleased(SDL_Keycode code);
 bool Input_IsQuitPressed();
+/*
+ * True for the update following a change of the window's size, which
+ * Graphic_QueryWindowSize already returns. Layouts only need to be redone
+ * then.
+ */
+bool Input_IsWindowResized();
+bool Input_IsMouseButtonReleased(MouseButton buttons);
 bool Input_IsZoneClicked(SDL_Rect zone, MouseButton buttons);
 bool Input_IsMouseOverZone(SDL_Rect zone);
 void Input_QueryMouseTranslation(int* dx, int* dy);
@@ -0,0 +1,90 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compiled level file, produced from a text description by
+ * tools/level-compiler. The file is a header followed by flat tables that
+ * are used in place: Level_Open maps the file and only checks that every
+ * table, chunk and id it points at is in range, so nothing is parsed or
+ * copied at load time.
+ *
+ * All fields are little-endian and every table starts on a 4 byte boundary.
+ * Ground and object tiles are stored in chunks of LEVEL_CHUNK_SIZE squared
+ * cells, row by row, matching the chunks of the game's tilemaps. Chunks
+ * with nothing but empty tiles are left out of the file.
+ */
+
+#define LEVEL_MAGIC "LMNL"
+#define LEVEL_VERSION 1
+#define LEVEL_CHUNK_SHIFT 5
+#define LEVEL_CHUNK_SIZE (1 << LEVEL_CHUNK_SHIFT)
+#define LEVEL_CHUNK_CELLS (LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE)
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t width, height;
+  uint32_t totalLanes, lanesOffset;
+  uint32_t totalSpawns, spawnsOffset;
+  uint32_t totalObjects, objectsOffset;
+  uint32_t totalPrefabs, prefabsOffset;
+  uint32_t totalPrefabObjects, prefabObjectsOffset;
+  uint32_t totalInstances, instancesOffset;
+  uint32_t totalChunks, chunksOffset;
+} Level_Header;
+
+/*
+ * Offsets of LEVEL_CHUNK_CELLS uint16_t tiles, or 0 when that layer of the
+ * chunk is empty.
+ */
+typedef struct {
+  uint16_t x, y;
+  uint32_t groundOffset;
+  uint32_t objectOffset;
+} Level_Chunk;
+
+typedef struct {
+  uint32_t tile;
+  float x, y, z;
+} Level_Object;
+
+/* A run of totalObjects prefab objects, relative to where it is placed. */
+typedef struct {
+  uint32_t firstObject;
+  uint32_t totalObjects;
+} Level_Prefab;
+
+typedef struct {
+  uint32_t prefab;
+  int32_t x, y;
+} Level_Instance;
+
+typedef struct {
+  const Level_Header* header;
+  /* Lane coordinates, indexed by Lane. */
+  const int32_t* lanes;
+  /* Paths of the customers present when the level starts. */
+  const uint32_t* spawns;
+  const Level_Object* objects;
+  const Level_Prefab* prefabs;
+  const Level_Object* prefabObjects;
+  const Level_Instance* instances;
+  const Level_Chunk* chunks;
+  const unsigned char* data;
+  size_t size;
+} Level;
+
+bool Level_Open(Level* level, const char* filename);
+void Level_Close(Level* level);
+
+static inline const uint16_t*
+Level_GetCells(const Level* level, uint32_t offset)
+{
+  return offset ? (const uint16_t*) (level->data + offset) : NULL;
+}
+
+#endif
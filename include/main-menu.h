@@ -1,6 +1,10 @@
 #ifndef MAIN_MENU_H
 #define MAIN_MENU_H
 
+/*
+ * Pushes the menu, which stays below the game to be shown again as is,
+ * with a new simulation running in its background.
+ */
 void MainMenu_Enter();
 
 #endif
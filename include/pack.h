@@ -0,0 +1,58 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Asset pack, produced from the game's images by tools/asset-packer. Every
+ * image is stored decoded, with the magenta colour key turned into alpha and
+ * the alpha premultiplied, in the pixel format textures are created with.
+ * Pack_Open maps the file and only checks that every image is in range, so
+ * loading a texture is a single upload straight from the mapping.
+ *
+ * All fields are little-endian. Pixels are PACK_PIXEL_BYTES each, rows are
+ * pitch bytes apart and every image starts on a PACK_PAGE boundary.
+ */
+
+#define PACK_MAGIC "LMNP"
+#define PACK_VERSION 1
+#define PACK_NAME 64
+#define PACK_PAGE 4096
+#define PACK_PIXEL_BYTES 4
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  /* SDL_PixelFormatEnum of every image. */
+  uint32_t format;
+  uint32_t totalImages, imagesOffset;
+} Pack_Header;
+
+/* Named after the file it was packed from. */
+typedef struct {
+  char name[PACK_NAME];
+  uint32_t w, h, pitch;
+  uint32_t pixelsOffset;
+} Pack_Image;
+
+typedef struct {
+  const Pack_Header* header;
+  const Pack_Image* images;
+  const unsigned char* data;
+  size_t size;
+} Pack;
+
+bool Pack_Open(Pack* pack, const char* filename);
+void Pack_Close(Pack* pack);
+/* Returns NULL when name isn't in the pack or the pack isn't open. */
+const Pack_Image* Pack_Find(const Pack* pack, const char* name);
+
+static inline const void*
+Pack_GetPixels(const Pack* pack, const Pack_Image* image)
+{
+  return pack->data + image->pixelsOffset;
+}
+
+#endif
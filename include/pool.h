@@ -0,0 +1,76 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+/*
+ * Handle pool for DOD stores. Elements live densely in [0, total) of every
+ * registered column; handles stay valid while elements move around.
+ *
+ * A handle is the element's slot in the low 24 bits (INDEX_INDEX_MASK) and
+ * the slot's generation in the high 8 bits. Deleting an element bumps the
+ * generation of its slot, so a stale handle is detected until the slot has
+ * been reused 256 times.
+ */
+
+#define POOL_MAX_COLUMNS 4
+#define POOL_GENERATION_SHIFT 24
+
+typedef struct {
+  void** data;
+  size_t size;
+} Pool_Column;
+
+typedef struct {
+  Index* indexes;
+  Id* ids;
+  TinyId* generations;
+  Index total;
+  Index capacity;
+  Index max;
+  Index next_free_index;
+  Pool_Column columns[POOL_MAX_COLUMNS];
+  int totalColumns;
+} Pool;
+
+#define POOL_ADD_COLUMN(pool, column) \
+  Pool_AddColumn(pool, (void**) &(column), sizeof(*(column)))
+
+void Pool_Init(Pool* pool, Index capacity, Index max);
+void Pool_AddColumn(Pool* pool, void** data, size_t size);
+void Pool_Free(Pool* pool);
+void Pool_Clear(Pool* pool);
+
+Id Pool_Create(Pool* pool, Index* index);
+void Pool_CreateMany(Pool* pool, Index count, Id* ids);
+void Pool_Delete(Pool* pool, Id id);
+void Pool_DeleteAt(Pool* pool, Index index);
+void Pool_DeleteMany(Pool* pool, const Id* ids, Index count);
+void Pool_Swap(Pool* pool, Index a, Index b);
+void Pool_Move(Pool* pool, Index from, Index to);
+bool Pool_Check(const Pool* pool);
+
+static inline bool
+Pool_Has(const Pool* pool, Id id)
+{
+  Index slot = id & INDEX_INDEX_MASK;
+  if (slot >= pool->capacity ||
+      pool->generations[slot] != id >> POOL_GENERATION_SHIFT) {
+    return false;
+  }
+
+  Index index = pool->indexes[slot];
+  return index < pool->total && pool->ids[index] == id;
+}
+
+static inline Index
+Pool_GetIndex(const Pool* pool, Id id)
+{
+  assert(Pool_Has(pool, id));
+  return pool->indexes[id & INDEX_INDEX_MASK];
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * PCG32 (XSH RR) generator with explicit state. Two states seeded with the
+ * same seed but different streams produce independent sequences, so every
+ * thread or spawner can own one and stay reproducible.
+ */
+
+typedef struct {
+  uint64_t state;
+  uint64_t increment;
+} Random_State;
+
+// A valid fixed state, for generators used before they are seeded.
+#define RANDOM_INITIALIZER { 0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL }
+
+void Random_Seed(Random_State* random, uint64_t seed, uint64_t stream);
+Random_State* Random_Default();
+
+uint32_t Random_Next(Random_State* random);
+uint32_t Random_Range(Random_State* random, uint32_t bound);
+double Random_NextDouble(Random_State* random);
+
+void Random_Fill(Random_State* random, uint32_t* values, size_t count);
+void Random_FillRange(
+  Random_State* random,
+  uint32_t* values,
+  size_t count,
+  uint32_t bound
+);
+void Random_FillDouble(Random_State* random, double* values, size_t count);
+
+#endif
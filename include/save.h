@@ -0,0 +1,113 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game-types.h"
+#include "level.h"
+#include "random.h"
+
+/*
+ * Snapshot of a running game. Saving happens in two steps: the game copies
+ * its state into a Save_State on the main thread, which only takes a few
+ * memcpy, then Save_WriteAsync packs it into the file format and writes it
+ * on a worker thread.
+ *
+ * The file is a header, the game objects as one array per field, the
+ * prefabs they were instanced from, and the map's chunks in the same layout
+ * as in level files. Save_Open reads it
+ * back and checks it, so the game can copy each array in one go.
+ */
+
+#define SAVE_MAGIC "LMNS"
+#define SAVE_VERSION 3
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t width, height;
+  int32_t lanes[TotalLanes];
+  uint64_t randomState, randomIncrement;
+  /*
+   * Offset of the objects' x, then y, z, dx, dy and dz as doubles, then
+   * their tiles and paths as uint32_t and their prefab slices as int32_t,
+   * -1 when the object isn't one, each array totalObjects long.
+   */
+  uint32_t totalObjects, objectsOffset;
+  uint32_t totalPrefabs, prefabsOffset;
+  uint32_t totalPrefabObjects, prefabObjectsOffset;
+  uint32_t totalChunks, chunksOffset;
+} Save_Header;
+
+typedef struct {
+  int x, y;
+  bool hasGround, hasObjects;
+  unsigned int ground[LEVEL_CHUNK_CELLS];
+  unsigned int objects[LEVEL_CHUNK_CELLS];
+} Save_Chunk;
+
+typedef struct {
+  uint32_t width, height;
+  int32_t lanes[TotalLanes];
+  Random_State random;
+  uint32_t totalObjects;
+  double* x;
+  double* y;
+  double* z;
+  double* dx;
+  double* dy;
+  double* dz;
+  uint32_t* tiles;
+  uint32_t* paths;
+  int32_t* slices;
+  uint32_t totalPrefabs;
+  Level_Prefab* prefabs;
+  uint32_t totalPrefabObjects;
+  Level_Object* prefabObjects;
+  uint32_t totalChunks;
+  Save_Chunk* chunks;
+} Save_State;
+
+typedef struct {
+  const Save_Header* header;
+  const double* x;
+  const double* y;
+  const double* z;
+  const double* dx;
+  const double* dy;
+  const double* dz;
+  const uint32_t* tiles;
+  const uint32_t* paths;
+  const int32_t* slices;
+  const Level_Prefab* prefabs;
+  const Level_Object* prefabObjects;
+  const Level_Chunk* chunks;
+  unsigned char* data;
+  size_t size;
+} Save_File;
+
+/* Allocates a state with room for the given number of each element. */
+Save_State* Save_CreateState(
+    uint32_t totalObjects, 
+    uint32_t totalPrefabs, 
+    uint32_t totalPrefabObjects, 
+    uint32_t totalChunks
+);
+void Save_FreeState(Save_State* state);
+
+/*
+ * Takes ownership of the state and writes it to filename on a worker
+ * thread, through a temporary file so a crash never leaves half a save.
+ * Waits for the previous save first if it is still being written.
+ */
+void Save_WriteAsync(Save_State* state, const char* filename);
+/* Blocks until the save being written, if any, is on disk. */
+void Save_Wait();
+
+bool Save_Open(Save_File* file, const char* filename);
+const uint16_t* Save_GetCells(const Save_File* file, uint32_t offset);
+void Save_Close(Save_File* file);
+
+#endif
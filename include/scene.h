@@ -6,7 +6,41 @@ void Scene_GameLoop();
 
 typedef void (*UpdateFunc)(void);
 
-void Scene_SetUpdateTo(UpdateFunc);
+/*
+ * Scenes are stacked and only the top one is updated. Those below keep
+ * their sprites and data, so going back to one doesn't rebuild it: hide and
+ * show, which may be NULL, are called when a scene gets covered and
+ * uncovered.
+ *
+ * Each scene owns the textures, sprites and widgets it creates. They are
+ * all released at once when it is popped, right after exit, which may be
+ * NULL, lets it forget about them.
+ */
+typedef struct {
+  UpdateFunc update;
+  void (*hide)(void);
+  void (*show)(void);
+  void (*exit)(void);
+} Scene;
+
+void Scene_Push(const Scene* scene);
+void Scene_Pop();
+const Scene* Scene_GetCurrent();
+
+/*
+ * Runs load on a worker thread while the current scene keeps updating and
+ * rendering, then ready on the main thread between two updates. loaded is
+ * false when load failed or the game is quitting, in which case ready only
+ * releases what load acquired. Only one load runs at a time: returns false,
+ * without running anything, while another one hasn't finished.
+ */
+typedef bool (*Scene_LoadFunc)(void* data);
+typedef void (*Scene_ReadyFunc)(void* data, bool loaded);
+bool Scene_LoadInBackground(Scene_LoadFunc load, Scene_ReadyFunc ready, void* data);
+bool Scene_IsLoading();
+/* Blocks until the background load, if any, is done and hands it over. */
+void Scene_FinishLoading();
+
 void Scene_Quit();
 
 #endif
@@ -0,0 +1,55 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Sparse grid of unsigned int cells for runtime-sized maps. Cells live in
+ * 32x32 chunks stored row by row, and chunks are only allocated once a cell
+ * in them gets a value other than the map's empty value, so memory follows
+ * the populated area rather than the map size. Chunks are found through an
+ * open addressing hash table keyed by chunk coordinates.
+ */
+
+#define TILEMAP_CHUNK_SHIFT 5
+#define TILEMAP_CHUNK_SIZE (1 << TILEMAP_CHUNK_SHIFT)
+#define TILEMAP_CHUNK_MASK (TILEMAP_CHUNK_SIZE - 1)
+#define TILEMAP_MAX_SIZE (TILEMAP_CHUNK_SIZE * 0xFFFF)
+
+typedef struct {
+  unsigned int key;
+  unsigned int* cells;
+} Tilemap_Slot;
+
+typedef struct {
+  int width, height;
+  unsigned int empty;
+  Tilemap_Slot* slots;
+  unsigned int capacity;
+  unsigned int totalChunks;
+  int shift;
+} Tilemap;
+
+void Tilemap_Init(Tilemap* map, int width, int height, unsigned int empty);
+void Tilemap_Free(Tilemap* map);
+void Tilemap_Clear(Tilemap* map);
+
+unsigned int Tilemap_Get(const Tilemap* map, int x, int y);
+void Tilemap_Set(Tilemap* map, int x, int y, unsigned int value);
+bool Tilemap_Has(const Tilemap* map, int x, int y);
+
+/*
+ * Cells of chunk (cx, cy), TILEMAP_CHUNK_SIZE per row, or NULL if nothing
+ * was set in it. Cells past the map's edge hold the empty value.
+ */
+const unsigned int* Tilemap_QueryChunk(const Tilemap* map, int cx, int cy);
+
+/*
+ * Writable cells of chunk (cx, cy), allocating it filled with the empty
+ * value if needed, for filling a whole chunk at once.
+ */
+unsigned int* Tilemap_AcquireChunk(Tilemap* map, int cx, int cy);
+size_t Tilemap_QueryMemory(const Tilemap* map);
+
+#endif
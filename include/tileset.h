@@ -0,0 +1,33 @@
+#ifndef TILESET_H
+#define TILESET_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "game-types.h"
+
+/*
+ * Where each tile is in the sprite sheet, read from a text file (see
+ * tiles.txt) into a table indexed by tile, so the art can be rearranged
+ * without rebuilding the game.
+ */
+
+typedef struct {
+  SDL_Rect src;
+  /* How far left and up of its tile's top corner the tile is drawn. */
+  SDL_Point anchor;
+  /* Frame shown after this one when animated, the tile itself if none. */
+  GameTiles next;
+} Tileset_Tile;
+
+/*
+ * Fills tiles from filename. Tiles whose anchor isn't given rest their
+ * bottom on a tile tileHeight pixels high. Empty keeps an empty rect.
+ */
+bool Tileset_Load(
+    Tileset_Tile tiles[TotalGameTiles], 
+    const char* filename, 
+    int tileHeight
+);
+
+#endif
@@ -40,79 +40,11 @@ extern "C" {
 #define VOID_SMALL_INDEX ((SmallIndex) -1)
 #define VOID_INDEX ((Index) -1)
 
-#define HAS_ID(strct, id) (strct.ids[strct.indexes[id]] == id)
-
-#define SET_STRUCT_FOR_DOD(index_type, max) \
-    index_type indexes[max]; \
-    index_type next_free_index; \
-    index_type total; \
-    index_type ids[max]
-
-#define SET_ID_INDEX(strct, id, index) \
-do { \
-    strct.indexes[id] = index; \
-} while (0)
-
-#define INC_ID_INDEX(strct, id) \
-do { \
-    strct.indexes[id]++; \
-} while (0)
-
 #define GET_NAME(var) #var
 
-#define GET_NEXT_ID(strct, id, index, max) \
-do \
-{ \
-  assert(strct.total < max - 1); \
-  id = strct.next_free_index; \
-  strct.next_free_index = strct.indexes[id]; \
-  index = strct.indexes[id] = strct.total++; \
-  strct.ids[index] = id; \
-} while (0)
-
-#define INIT_STRUCT_FOR_DOD_FREE_LIST(strct, length) \
-do { \
-    for(unsigned long i = 0ul; i < (unsigned long) length; i++) { \
-        strct.indexes[i] = i + 1ul; \
-    } \
-} while (0)
-
 #define ARRAY_LENGTH(arr) sizeof(arr) / sizeof(arr[0])
 #define SHIFT_ONE_POSITION(arr, i, limit, type) memcpy(&arr[i + 1], &arr[i], (limit - i - 1) * sizeof(type))
 
-#define EXIT_IF_HAS_NOT_ID(strct, id) \
-  assert(HAS_ID(strct, id))
-
-#define DELETE_DOD_ELEMENT_BY_INDEX(strct, id, index, last) \
-do \
-{ \
-  last = --strct.total; \
-  id = strct.ids[index]; \
-  strct.indexes[id] = strct.next_free_index; \
-  strct.next_free_index = id; \
-  if (strct.ids[index] == strct.ids[last]) { \
-    break; \
-  } \
-  strct.ids[index] = strct.ids[last]; \
-  strct.indexes[strct.ids[index]] = index; \
-} while (0)
-
-#define DELETE_DOD_ELEMENT_BY_ID(strct, id, index, last) \
-do \
-{ \
-  GET_INDEX_FROM_ID(strct, id, index); \
-  DELETE_DOD_ELEMENT_BY_INDEX(strct, id, index, last); \
-} while (0)
-
-
-#define GET_INDEX_FROM_ID(strct, id, index) \
-do \
-{ \
-  EXIT_IF_HAS_NOT_ID(strct, id); \
-  index = strct.indexes[id]; \
-} \
-while (0)
-
 double utils_random();
 
 #ifdef __cplusplus
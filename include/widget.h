@@ -2,8 +2,12 @@
 #define WIDGET_H
 
 #include <SDL2/SDL.h>
+#include <stdbool.h>
 #include "utils.h"
 
+/* A width or height sizing the widget after its text or image. */
+#define WIDGET_AUTO -1
+
 typedef enum {
   UnitInPercentFlags_Width = 1 << 1,
   UnitInPercentFlags_Height = 1 << 2,
@@ -38,11 +42,26 @@ typedef enum {
 } Widget_HorizontalAlignment;
 
 
+/*
+ * Events go to the widget drawn last under the mouse, or to its closest
+ * ancestor listening to them. Widget_OnClick fires when the left button is
+ * released over it, Widget_OnFocus when the mouse enters or leaves it, which
+ * Widget_IsFocused tells apart.
+ */
 typedef void (*Widget_OnHandlerFunc)(Id el, Widget_Events e);
 
+/* Children are placed relative to their parent and drawn after it. */
 Id Widget_Create(Id parent);
+/* Deletes the widget with its children. */
+void Widget_Delete(Id id);
+/* A widget has one handler per event, Widget_All setting every one. */
 void Widget_AddEventListener(Id el, Widget_Events e, Widget_OnHandlerFunc handler);
 void Widget_RemoveEventListener(Id el, Widget_Events e, Widget_OnHandlerFunc handler);
+/* Fires the handlers of the inputs just polled. */
+void Widget_HandleEvents();
+bool Widget_IsFocused(Id id);
+/* How many widgets are alive. */
+Index Widget_GetTotal();
 void Widget_Render();
 void Widget_Init();
 void Widget_SetAligments(
@@ -60,8 +79,16 @@ void Widget_SetPosition(
     UnitInPercentFlags flags
 );
 
-void Widget_SetText(Id id, const char * const text);
+void Widget_SetText(Id id, const char * const text, SDL_Color color);
 void Widget_SetImage(Id id, const char * const image);
 void Widget_SetSrc(Id id, SDL_Rect src);
+/*
+ * Hiding a widget hides its children too. They are still laid out, so they
+ * are in place when shown again.
+ */
+void Widget_SetHidden(Id id, bool hidden);
+/* Closing a scope deletes the widgets created since it was opened. */
+void Widget_OpenScope();
+void Widget_CloseScope();
  
 #endif
@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define FRAME_ARENA_SIZE (1024 * 1024)
+
+static Arena _frame;
+
+void
+Arena_Init(Arena* arena, const char* name, size_t size)
+{
+  arena->data = malloc(size);
+  if (arena->data == NULL) {
+    fprintf(stderr, "Couldn't allocate %zu bytes for arena %s!\n", size, name);
+    exit(EXIT_FAILURE);
+  }
+  arena->size = size;
+  arena->used = 0;
+  arena->peak = 0;
+  arena->name = name;
+}
+
+void
+Arena_Free(Arena* arena)
+{
+  free(arena->data);
+  memset(arena, 0, sizeof(*arena));
+}
+
+void*
+Arena_Alloc(Arena* arena, size_t size, size_t alignment)
+{
+  assert(alignment && (alignment & (alignment - 1)) == 0);
+
+  uintptr_t base = (uintptr_t) arena->data;
+  uintptr_t start = (base + arena->used + alignment - 1) & ~(alignment - 1);
+  size_t used = start - base + size;
+
+  if (used > arena->size) {
+    fprintf(
+      stderr,
+      "Arena %s overflowed: %zu bytes requested, %zu of %zu in use!\n",
+      arena->name,
+      size,
+      arena->used,
+      arena->size
+    );
+    exit(EXIT_FAILURE);
+  }
+
+  arena->used = used;
+  if (used > arena->peak) {
+    arena->peak = used;
+  }
+  return (void*) start;
+}
+
+void*
+Arena_AllocZeroed(Arena* arena, size_t size, size_t alignment)
+{
+  void* data = Arena_Alloc(arena, size, alignment);
+  memset(data, 0, size);
+  return data;
+}
+
+Arena_Mark
+Arena_GetMark(const Arena* arena)
+{
+  return arena->used;
+}
+
+void
+Arena_ResetTo(Arena* arena, Arena_Mark mark)
+{
+  assert(mark <= arena->used);
+  arena->used = mark;
+}
+
+void
+Arena_Reset(Arena* arena)
+{
+  arena->used = 0;
+}
+
+Arena*
+Arena_GetFrame()
+{
+  if (_frame.data == NULL) {
+    Arena_Init(&_frame, "frame", FRAME_ARENA_SIZE);
+  }
+  return &_frame;
+}
+
+void
+Arena_Quit()
+{
+  Arena_Free(&_frame);
+}
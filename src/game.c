@@ -1,137 +1,158 @@
 #include <math.h>
+#include <string.h>
+#include "arena.h"
 #include "game.h"
+#include "game-types.h"
 #include "scene.h"
 #include "input.h"
+#include "level.h"
 #include "graphic.h"
-#include "main-menu.h"
+#include "random.h"
+#include "save.h"
+#include "tilemap.h"
+#include "tileset.h"
 #include "utils.h"
 
 static Id _spriteSheetId = VOID_ID;
 
-typedef enum {
-  GameTile_Empty,
-  GameTile_Grass,
-  GameTile_SideWalk,
-  GameTile_CrosswalkNorthSouth1,
-  GameTile_CrosswalkNorthSouth2,
-  GameTile_CrosswalkEastWest1,
-  GameTile_CrosswalkEastWest2,
-  GameTile_Road,
-  GameTile_Stand,
-  GameTile_StandingCharacterSouth,
-  GameTile_StandingCharacterEast,
-  GameTile_StandingCharacterNorth,
-  GameTile_StandingCharacterWest,
-  GameTile_WalkingCharacterSouth1,
-  GameTile_WalkingCharacterEast1,
-  GameTile_WalkingCharacterNorth1,
-  GameTile_WalkingCharacterWest1,
-  GameTile_WalkingCharacterSouth2,
-  GameTile_WalkingCharacterEast2,
-  GameTile_WalkingCharacterNorth2,
-  GameTile_WalkingCharacterWest2,
-  GameTile_StopSignFacingEast,
-  GameTile_StopSignFacingSouth,
-  GameTile_StopSignFacingWest,
-  GameTile_StopSignFacingNorth,
-  GameTile_Bush,
-  GameTile_LeftHouseCorner,
-  GameTile_HouseDoor,
-  GameTile_Wall,
-  GameTile_RightHouseCorner,
-  GameTile_HouseRightWallFirstSection,
-  GameTile_HouseRightWallCenterSection,
-  GameTile_HouseRightWallThirdSection,
-  GameTile_HouseRightWallLastSection,
-  GameTile_HouseRoof,
-  GameTile_HouseLeftRoof,
-  GameTile_HouseTopRoof,
-  GameTile_HouseTopLeftRoof,
-  GameTile_FrontPorchStair,
-  GameTile_NorthToSouthEntryWalkway,
-  GameTile_EastToWestFence,
-  GameTile_SouthToNorthFence,
-  GameTile_EastToWestFenceEntrance,
-  GameTile_WestToNorthFenceCorner,
-  GameTile_NorthToSouthFence,
-  GameTile_EastToNorthFenceCorner,
-} GameTiles;
-
-#define MAP_WIDTH 50
-#define MAP_HEIGHT 50
+#define DEFAULT_LEVEL "levels/first-level.lvl"
+#define SPRITE_SHEET "sprite-sheet2.bmp"
+#define TILESET "tiles.txt"
 #define TILE_WIDTH 32
 #define TILE_HEIGHT 16
 #define MAX_GAME_OBJECTS 1000
-#define NORTH_TO_SOUTH_WEST_SIDE_LANE 26
-#define SOUTH_TO_NORTH_WEST_SIDE_LANE 27
-#define NORTH_TO_SOUTH_EAST_SIDE_LANE 36
-#define SOUTH_TO_NORTH_EAST_SIDE_LANE 37
-#define EAST_TO_WEST_NORTH_SIDE_LANE 10
-#define WEST_TO_EAST_NORTH_SIDE_LANE 11
-#define EAST_TO_WEST_SOUTH_SIDE_LANE 20
-#define WEST_TO_EAST_SOUTH_SIDE_LANE 21
-#define STAND_X 25
-#define STAND_Y 25
-
-static GameTiles _groundTiles[MAP_HEIGHT][MAP_WIDTH];
-static GameTiles _objectTiles[MAP_HEIGHT][MAP_WIDTH];
-static Id _tilesSpriteId[MAP_HEIGHT][MAP_WIDTH];
-static Id _tilesObjectSpriteId[MAP_HEIGHT][MAP_WIDTH];
-
-typedef enum {
-  NoPath,
-  SouthToNorthOnWestSide,
-  NorthToSouthOnWestSide,
-  SouthToNorthOnEastSide,
-  NorthToSouthOnEastSide,
-  SouthOnWestSideToWestOnSouthSide,
-  WestOnSouthSideToSouthOnWestSide,
-  SouthOnEastSideToWestOnSouthSide,
-  WestOnSouthSideToSouthOnEastSide,
-  NorthOnWestSideToWestOnSouthSide,
-  WestOnSouthSideToNorthOnWestSide,
-  NorthOnEastSideToWestOnSouthSide,
-  WestOnSouthSideToNorthOnEastSide,
-  SouthOnWestSideToWestOnNorthSide,
-  WestOnNorthSideToSouthOnWestSide,
-  SouthOnEastSideToWestOnNorthSide,
-  WestOnNorthSideToSouthOnEastSide,
-  NorthOnWestSideToWestOnNorthSide,
-  WestOnNorthSideToNorthOnWestSide,
-  NorthOnEastSideToWestOnNorthSide,
-  WestOnNorthSideToNorthOnEastSide,
-} Path;
+#define MAX_PREFABS 64
+#define MAX_PREFAB_OBJECTS 4096
+#define NO_SLICE -1
+/*
+ * Objects only hold a sprite while they are near the screen: they get one
+ * within VIEW_MARGIN pixels of it and lose it twice as far, so objects
+ * around the edge don't keep trading theirs.
+ */
+#define VIEW_MARGIN (4 * TILE_WIDTH)
+#define ANIMATION_TICKS 16
+#define NORTH_TO_SOUTH_WEST_SIDE_LANE (_lanes[Lane_NorthToSouthWestSide])
+#define SOUTH_TO_NORTH_WEST_SIDE_LANE (_lanes[Lane_SouthToNorthWestSide])
+#define NORTH_TO_SOUTH_EAST_SIDE_LANE (_lanes[Lane_NorthToSouthEastSide])
+#define SOUTH_TO_NORTH_EAST_SIDE_LANE (_lanes[Lane_SouthToNorthEastSide])
+#define EAST_TO_WEST_NORTH_SIDE_LANE (_lanes[Lane_EastToWestNorthSide])
+#define WEST_TO_EAST_NORTH_SIDE_LANE (_lanes[Lane_WestToEastNorthSide])
+#define EAST_TO_WEST_SOUTH_SIDE_LANE (_lanes[Lane_EastToWestSouthSide])
+#define WEST_TO_EAST_SOUTH_SIDE_LANE (_lanes[Lane_WestToEastSouthSide])
 
+static const char* _levelFilename = DEFAULT_LEVEL;
+static int _lanes[TotalLanes];
+static Tileset_Tile _tiles[TotalGameTiles];
+// Clip of the frames each animated tile goes through, VOID_ID for the others.
+static Id _clips[TotalGameTiles];
+static Id _groundLayer = VOID_ID;
+
+/* Read on a worker by Game_Enter while the current scene keeps running. */
+static struct {
+  const char* filename;
+  Level level;
+  Tileset_Tile tiles[TotalGameTiles];
+  Id spriteSheet;
+} _preload;
+
+static struct {
+  int width, height;
+  Tilemap groundTiles;
+  Tilemap objectTiles;
+  Tilemap tilesObjectSpriteId;
+} _map;
+
+/*
+ * Object layer cells holding a sprite, so that those leaving the view are
+ * found without going through the map. The cells near the view are only
+ * looked at again once it has moved. Sprites reach past their cell by at
+ * most reach, set with the tiles.
+ */
+static struct {
+  SDL_Point* cells;
+  int total, capacity;
+  SDL_Rect view;
+  bool rescan;
+  int reach;
+} _tileObjects;
+
+/*
+ * Prefabs are split into one slice per row of tiles, and each slice is
+ * baked into a texture once. An instance is then one game object per slice,
+ * sorted like any other object by the slice's first tile, instead of one
+ * game object per tile.
+ */
 typedef struct {
-  Id sprite;
-  double x, y, z, dx, dy, dz;
-  GameTiles tile;
-  Path path;
-} GameObject;
+  int prefab;
+  int firstObject, totalObjects;
+  double x, y;
+  Id texture;
+  SDL_Rect bounds;
+} PrefabSlice;
+
+static struct {
+  int totalPrefabs;
+  Level_Prefab prefabs[MAX_PREFABS];
+  int firstSlice[MAX_PREFABS];
+  int sliceCounts[MAX_PREFABS];
+  int totalObjects;
+  Level_Object objects[MAX_PREFAB_OBJECTS];
+  // Each slice has at least one object.
+  int totalSlices;
+  PrefabSlice slices[MAX_PREFAB_OBJECTS];
+} _prefabs;
 
-static GameObject _gameObjects[MAX_GAME_OBJECTS];
+static struct {
+  Id sprite[MAX_GAME_OBJECTS];
+  double x[MAX_GAME_OBJECTS];
+  double y[MAX_GAME_OBJECTS];
+  double z[MAX_GAME_OBJECTS];
+  double dx[MAX_GAME_OBJECTS];
+  double dy[MAX_GAME_OBJECTS];
+  double dz[MAX_GAME_OBJECTS];
+  GameTiles tile[MAX_GAME_OBJECTS];
+  Path path[MAX_GAME_OBJECTS];
+  int slice[MAX_GAME_OBJECTS];
+} _gameObjects;
 static int _activeGameObjects;
+static bool _spriteOrderDirty = false;
+static Random_State _random = RANDOM_INITIALIZER;
 
 static double _cameraDx;
 static double _cameraDy;
 
-static int _dt = 0;
 static bool _pause = false;
 
+#define SWAP(type, a, b) do { type tmp = (a); (a) = (b); (b) = tmp; } while (0)
+
+static void
+_swapGameObjects(int i, int j)
+{
+  SWAP(Id, _gameObjects.sprite[i], _gameObjects.sprite[j]);
+  SWAP(double, _gameObjects.x[i], _gameObjects.x[j]);
+  SWAP(double, _gameObjects.y[i], _gameObjects.y[j]);
+  SWAP(double, _gameObjects.z[i], _gameObjects.z[j]);
+  SWAP(double, _gameObjects.dx[i], _gameObjects.dx[j]);
+  SWAP(double, _gameObjects.dy[i], _gameObjects.dy[j]);
+  SWAP(double, _gameObjects.dz[i], _gameObjects.dz[j]);
+  SWAP(GameTiles, _gameObjects.tile[i], _gameObjects.tile[j]);
+  SWAP(Path, _gameObjects.path[i], _gameObjects.path[j]);
+  SWAP(int, _gameObjects.slice[i], _gameObjects.slice[j]);
+}
+
 static void 
 _reorderGameObjects()
 {
   double k = 0, l = 0, nk, nl;
   int next = 0;
-  GameObject tmp;
   bool dirty = false;
   for (int i = 0; i < _activeGameObjects - 1; i++) {
-    k = _gameObjects[i].x * MAP_WIDTH + _gameObjects[i].y;
-    l = _gameObjects[i].y * MAP_HEIGHT + _gameObjects[i].x;
+    k = _gameObjects.x[i] * _map.width + _gameObjects.y[i];
+    l = _gameObjects.y[i] * _map.height + _gameObjects.x[i];
     next = i;
     for (int j = i + 1; j < _activeGameObjects; j++) {
-      nk = _gameObjects[j].x * MAP_WIDTH + _gameObjects[j].y;
-      nl = _gameObjects[j].y * MAP_HEIGHT + _gameObjects[j].x;
+      nk = _gameObjects.x[j] * _map.width + _gameObjects.y[j];
+      nl = _gameObjects.y[j] * _map.height + _gameObjects.x[j];
       if (nk < k && nl < l) {
         next = j;
         k = nk;
@@ -139,20 +160,13 @@ _reorderGameObjects()
       }
     }
     if (next != i) {
-      tmp = _gameObjects[i];
-      _gameObjects[i] = _gameObjects[next];
-      _gameObjects[next] = tmp;
+      _swapGameObjects(i, next);
       dirty = true;
     }
   }
 
   if (dirty) {
-    for (int i = 0; i < _activeGameObjects - 1; i++) {
-      Graphic_SetSpriteToBeAfterAnother(
-        _gameObjects[i + 1].sprite, 
-        _gameObjects[i].sprite
-      );
-    }
+    _spriteOrderDirty = true;
   }
 }
 
@@ -193,348 +207,42 @@ _handleCamera()
 static SDL_Rect
 _getTileSrc(GameTiles tile)
 {
-  SDL_Rect src;
-  switch (tile) {
-    case GameTile_Empty:
-      src.x = src.y = src.w = src.h = 0;
-      break;
-    case GameTile_Grass:
-      src.x = 0;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_SideWalk:
-      src.x = TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_Road:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_CrosswalkNorthSouth1:
-      src.x = 3 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_CrosswalkNorthSouth2:
-      src.x = 4 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_CrosswalkEastWest1:
-      src.x = 5 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_CrosswalkEastWest2:
-      src.x = 6 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_NorthToSouthEntryWalkway:
-      src.x = 7 * TILE_WIDTH;
-      src.y = 12 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = TILE_HEIGHT;
-      break;
-    case GameTile_Stand:
-      src.x = 0;
-      src.y = 13 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 4 * TILE_HEIGHT;
-      break;
-    case GameTile_StandingCharacterSouth:
-      src.x = 0;
-      src.y = 9 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_StandingCharacterEast:
-      src.x = 0;
-      src.y = 6 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_StandingCharacterNorth:
-      src.x = 0;
-      src.y = 3 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_StandingCharacterWest:
-      src.x = 0;
-      src.y = 0;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterSouth1:
-      src.x = TILE_WIDTH;
-      src.y = 9 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterEast1:
-      src.x = TILE_WIDTH;
-      src.y = 6 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterNorth1:
-      src.x = TILE_WIDTH;
-      src.y = 3 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterWest1:
-      src.x = TILE_WIDTH;
-      src.y = 0;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterSouth2:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 9 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterEast2:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 6 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterNorth2:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 3 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_WalkingCharacterWest2:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 0;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_StopSignFacingEast:
-      src.x = TILE_WIDTH;
-      src.y = 13 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 4 * TILE_HEIGHT;
-      break;
-    case GameTile_StopSignFacingSouth:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 13 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 4 * TILE_HEIGHT;
-      break;
-    case GameTile_StopSignFacingWest:
-      src.x = 3 * TILE_WIDTH;
-      src.y = 13 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 4 * TILE_HEIGHT;
-      break;
-    case GameTile_StopSignFacingNorth:
-      src.x = 4 * TILE_WIDTH;
-      src.y = 13 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 4 * TILE_HEIGHT;
-      break;
-    case GameTile_Bush:
-      src.x = 0;
-      src.y = 17 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_LeftHouseCorner:
-      src.x = 5 * TILE_WIDTH;
-      src.y = 27 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 7 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseDoor:
-      src.x = 6 * TILE_WIDTH;
-      src.y = 27 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 7 * TILE_HEIGHT;
-      break;
-    case GameTile_Wall:
-      src.x = 7 * TILE_WIDTH;
-      src.y = 27 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 7 * TILE_HEIGHT;
-      break;
-    case GameTile_RightHouseCorner:
-      src.x = 8 * TILE_WIDTH;
-      src.y = 27 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 7 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseRightWallFirstSection:
-      src.x = 4 * TILE_WIDTH;
-      src.y = 26 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 8 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseRightWallCenterSection:
-      src.x = 3 * TILE_WIDTH;
-      src.y = 25 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 9 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseRightWallThirdSection:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 27 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 7 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseRightWallLastSection:
-      src.x = 1 * TILE_WIDTH;
-      src.y = 28 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 6 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseRoof:
-      src.x = 0 * TILE_WIDTH;
-      src.y = 28 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseLeftRoof:
-      src.x = 0 * TILE_WIDTH;
-      src.y = 31 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 3 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseTopRoof:
-      src.x = 0 * TILE_WIDTH;
-      src.y = 24 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_HouseTopLeftRoof:
-      src.x = 0 * TILE_WIDTH;
-      src.y = 26 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_FrontPorchStair:
-      src.x = 1 * TILE_WIDTH;
-      src.y = 26 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_EastToWestFence:
-      src.x = 1 * TILE_WIDTH;
-      src.y = 22 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_SouthToNorthFence:
-      src.x = 1 * TILE_WIDTH;
-      src.y = 24 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_EastToWestFenceEntrance:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 22 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_WestToNorthFenceCorner:
-      src.x = 2 * TILE_WIDTH;
-      src.y = 24 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_NorthToSouthFence:
-      src.x = 0 * TILE_WIDTH;
-      src.y = 22 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-    case GameTile_EastToNorthFenceCorner:
-      src.x = 3 * TILE_WIDTH;
-      src.y = 23 * TILE_HEIGHT;
-      src.w = TILE_WIDTH;
-      src.h = 2 * TILE_HEIGHT;
-      break;
-  }
-  return src;
-}
-
-static SDL_Rect 
-_getTileDest(SDL_Rect src, int x, int y)
-{
-  SDL_Rect dest;
-  dest.x = x * (TILE_WIDTH / 2) - y * (TILE_WIDTH / 2);
-  dest.y = x * (TILE_HEIGHT / 2) + y * (TILE_HEIGHT / 2);
-  dest.w = src.w;
-  dest.h = src.h;
-  return dest;
+  return _tiles[tile].src;
 }
 
 static SDL_Rect
-_getObjectSpriteDest(SDL_Rect src, int x, int y, int z)
+_getObjectSpriteDest(GameTiles tile, int x, int y, int z)
 {
   SDL_Rect dest;
-  dest.x = x * (TILE_WIDTH / 2) - y * (TILE_WIDTH / 2);
+  dest.x = x * (TILE_WIDTH / 2) - y * (TILE_WIDTH / 2) - _tiles[tile].anchor.x;
   dest.y = x * TILE_HEIGHT / 2 + y * TILE_HEIGHT / 2
-    - (src.h - TILE_HEIGHT) - z;
-  dest.w = src.w;
-  dest.h = src.h;
+    - _tiles[tile].anchor.y - z;
+  dest.w = _tiles[tile].src.w;
+  dest.h = _tiles[tile].src.h;
   return dest;
 }
 
 static void
-_animateGameObjects()
+_playTile(Id sprite, GameTiles tile)
 {
-  for (int i = 0; i < _activeGameObjects; i++) {
-    switch (_gameObjects[i].tile) {
-      case GameTile_WalkingCharacterSouth1: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterSouth2;
-        break;
-      case GameTile_WalkingCharacterSouth2: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterSouth1;
-        break;
-      case GameTile_WalkingCharacterNorth1: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterNorth2;
-        break;
-      case GameTile_WalkingCharacterNorth2: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterNorth1;
-        break;
-      case GameTile_WalkingCharacterEast1: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterEast2;
-        break;
-      case GameTile_WalkingCharacterEast2: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterEast1;
-        break;
-      case GameTile_WalkingCharacterWest1: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterWest2;
-        break;
-      case GameTile_WalkingCharacterWest2: 
-        _gameObjects[i].tile = GameTile_WalkingCharacterWest1;
-        break;
-    }
-    SDL_Rect src = _getTileSrc(_gameObjects[i].tile);
-    Graphic_SetSpriteSrcRect(_gameObjects[i].sprite, src);
+  if (_clips[tile] != VOID_ID) {
+    Graphic_PlayClip(sprite, _clips[tile]);
+  } else {
+    Graphic_StopClip(sprite);
+    Graphic_SetSpriteSrcRect(sprite, _getTileSrc(tile));
   }
 }
 
+/* Switches the object to the clip of tile, unless it is already playing it. */
 static void
-_animateGameObject(int i, GameTiles frame1, GameTiles frame2)
+_turnGameObject(int i, GameTiles tile)
 {
-  if (_gameObjects[i].tile != frame1 && _gameObjects[i].tile != frame2) {
-    _gameObjects[i].tile = frame1;
+  if (_gameObjects.tile[i] == tile) {
+    return;
+  }
+  _gameObjects.tile[i] = tile;
+  if (_gameObjects.sprite[i] != VOID_ID) {
+    _playTile(_gameObjects.sprite[i], tile);
   }
 }
 
@@ -542,7 +250,7 @@ static void
 _moveGameObjects()
 {
   for (int i = 0; i < _activeGameObjects; i++) {
-    switch(_gameObjects[i].path) {
+    switch(_gameObjects.path[i]) {
       case SouthToNorthOnWestSide:
       case SouthToNorthOnEastSide:
       case NorthToSouthOnWestSide:
@@ -550,173 +258,109 @@ _moveGameObjects()
         break;
       case WestOnSouthSideToNorthOnWestSide:
       case WestOnNorthSideToNorthOnWestSide:
-        if (_gameObjects[i].x >= SOUTH_TO_NORTH_WEST_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterNorth1, 
-            GameTile_WalkingCharacterNorth2
-          );
-          _gameObjects[i].dy = -0.05;
-          _gameObjects[i].dx = 0;
+        if (_gameObjects.x[i] >= SOUTH_TO_NORTH_WEST_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterNorth1);
+          _gameObjects.dy[i] = -0.05;
+          _gameObjects.dx[i] = 0;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterEast1, 
-            GameTile_WalkingCharacterEast2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = 0.05;
+          _turnGameObject(i, GameTile_WalkingCharacterEast1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = 0.05;
         }
         break;
       case WestOnSouthSideToNorthOnEastSide:
       case WestOnNorthSideToNorthOnEastSide:
-        if (_gameObjects[i].x >= SOUTH_TO_NORTH_EAST_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterNorth1, 
-            GameTile_WalkingCharacterNorth2
-          );
-          _gameObjects[i].dy = -0.05;
-          _gameObjects[i].dx = 0;
+        if (_gameObjects.x[i] >= SOUTH_TO_NORTH_EAST_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterNorth1);
+          _gameObjects.dy[i] = -0.05;
+          _gameObjects.dx[i] = 0;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterEast1, 
-            GameTile_WalkingCharacterEast2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = 0.05;
+          _turnGameObject(i, GameTile_WalkingCharacterEast1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = 0.05;
         }
         break;
       case WestOnNorthSideToSouthOnWestSide:
       case WestOnSouthSideToSouthOnWestSide:
-        if (_gameObjects[i].x >= NORTH_TO_SOUTH_WEST_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterSouth1, 
-            GameTile_WalkingCharacterSouth2
-          );
-          _gameObjects[i].dy = 0.05;
-          _gameObjects[i].dx = 0;
+        if (_gameObjects.x[i] >= NORTH_TO_SOUTH_WEST_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterSouth1);
+          _gameObjects.dy[i] = 0.05;
+          _gameObjects.dx[i] = 0;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterEast1, 
-            GameTile_WalkingCharacterEast2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = 0.05;
+          _turnGameObject(i, GameTile_WalkingCharacterEast1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = 0.05;
         }
         break;
       case WestOnSouthSideToSouthOnEastSide:
       case WestOnNorthSideToSouthOnEastSide:
-        if (_gameObjects[i].x >= NORTH_TO_SOUTH_EAST_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterSouth1, 
-            GameTile_WalkingCharacterSouth2
-          );
-          _gameObjects[i].dy = 0.05;
-          _gameObjects[i].dx = 0;
+        if (_gameObjects.x[i] >= NORTH_TO_SOUTH_EAST_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterSouth1);
+          _gameObjects.dy[i] = 0.05;
+          _gameObjects.dx[i] = 0;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterEast1, 
-            GameTile_WalkingCharacterEast2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = 0.05;
+          _turnGameObject(i, GameTile_WalkingCharacterEast1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = 0.05;
         }
         break;
       case SouthOnEastSideToWestOnSouthSide:
       case SouthOnWestSideToWestOnSouthSide:
-        if ((_gameObjects[i].y) <= WEST_TO_EAST_SOUTH_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterWest1, 
-            GameTile_WalkingCharacterWest2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = -0.05;
+        if ((_gameObjects.y[i]) <= WEST_TO_EAST_SOUTH_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterWest1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = -0.05;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterNorth1, 
-            GameTile_WalkingCharacterNorth2
-          );
-          _gameObjects[i].dy = -0.05;
-          _gameObjects[i].dx = 0;
+          _turnGameObject(i, GameTile_WalkingCharacterNorth1);
+          _gameObjects.dy[i] = -0.05;
+          _gameObjects.dx[i] = 0;
         }
         break;
       case SouthOnWestSideToWestOnNorthSide:
       case SouthOnEastSideToWestOnNorthSide:
-        if ((_gameObjects[i].y) <= WEST_TO_EAST_NORTH_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterWest1, 
-            GameTile_WalkingCharacterWest2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = -0.05;
+        if ((_gameObjects.y[i]) <= WEST_TO_EAST_NORTH_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterWest1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = -0.05;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterNorth1, 
-            GameTile_WalkingCharacterNorth2
-          );
-          _gameObjects[i].dy = -0.05;
-          _gameObjects[i].dx = 0;
+          _turnGameObject(i, GameTile_WalkingCharacterNorth1);
+          _gameObjects.dy[i] = -0.05;
+          _gameObjects.dx[i] = 0;
         }
         break;
       case NorthOnWestSideToWestOnSouthSide:
       case NorthOnEastSideToWestOnSouthSide:
-        if ((_gameObjects[i].y) >= WEST_TO_EAST_SOUTH_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterWest1, 
-            GameTile_WalkingCharacterWest2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = -0.05;
+        if ((_gameObjects.y[i]) >= WEST_TO_EAST_SOUTH_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterWest1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = -0.05;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterSouth1, 
-            GameTile_WalkingCharacterSouth2
-          );
-          _gameObjects[i].dy = 0.05;
-          _gameObjects[i].dx = 0;
+          _turnGameObject(i, GameTile_WalkingCharacterSouth1);
+          _gameObjects.dy[i] = 0.05;
+          _gameObjects.dx[i] = 0;
         }
         break;
       case NorthOnWestSideToWestOnNorthSide:
       case NorthOnEastSideToWestOnNorthSide:
-        if ((_gameObjects[i].y) >= WEST_TO_EAST_NORTH_SIDE_LANE) {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterWest1, 
-            GameTile_WalkingCharacterWest2
-          );
-          _gameObjects[i].dy = 0;
-          _gameObjects[i].dx = -0.05;
+        if ((_gameObjects.y[i]) >= WEST_TO_EAST_NORTH_SIDE_LANE) {
+          _turnGameObject(i, GameTile_WalkingCharacterWest1);
+          _gameObjects.dy[i] = 0;
+          _gameObjects.dx[i] = -0.05;
         } else {
-          _animateGameObject(
-            i, 
-            GameTile_WalkingCharacterSouth1, 
-            GameTile_WalkingCharacterSouth2
-          );
-          _gameObjects[i].dy = 0.05;
-          _gameObjects[i].dx = 0;
+          _turnGameObject(i, GameTile_WalkingCharacterSouth1);
+          _gameObjects.dy[i] = 0.05;
+          _gameObjects.dx[i] = 0;
         }
         break;
     }
-    double x = _gameObjects[i].x + _gameObjects[i].dx;
-    double y = _gameObjects[i].y + _gameObjects[i].dy;
+    double x = _gameObjects.x[i] + _gameObjects.dx[i];
+    double y = _gameObjects.y[i] + _gameObjects.dy[i];
 
-    switch(_gameObjects[i].path) {
+    switch(_gameObjects.path[i]) {
       case SouthToNorthOnWestSide:
       case SouthToNorthOnEastSide:
         if (y < 0) {
-          y = MAP_HEIGHT;
+          y = _map.height;
         }
         break;
       case WestOnNorthSideToNorthOnWestSide:
@@ -735,20 +379,20 @@ _moveGameObjects()
         break;
       case NorthToSouthOnWestSide:
       case NorthToSouthOnEastSide:
-        if (y >= MAP_HEIGHT) {
+        if (y >= _map.height) {
           y = 0;
         }
         break;
       case WestOnSouthSideToSouthOnWestSide:
       case WestOnSouthSideToSouthOnEastSide:
-        if (y >= MAP_HEIGHT) {
+        if (y >= _map.height) {
           x = 0;
           y = EAST_TO_WEST_SOUTH_SIDE_LANE;
         }
         break;
       case WestOnNorthSideToSouthOnWestSide:
       case WestOnNorthSideToSouthOnEastSide:
-        if (y >= MAP_HEIGHT) {
+        if (y >= _map.height) {
           x = 0;
           y = EAST_TO_WEST_NORTH_SIDE_LANE;
         }
@@ -757,14 +401,14 @@ _moveGameObjects()
       case SouthOnWestSideToWestOnNorthSide:
         if (x < 0) {
           x = SOUTH_TO_NORTH_WEST_SIDE_LANE;
-          y = MAP_HEIGHT;
+          y = _map.height;
         }
         break;
       case SouthOnEastSideToWestOnSouthSide:
       case SouthOnEastSideToWestOnNorthSide:
         if (x < 0) {
           x = SOUTH_TO_NORTH_EAST_SIDE_LANE;
-          y = MAP_HEIGHT;
+          y = _map.height;
         }
         break;
       case NorthOnWestSideToWestOnSouthSide:
@@ -784,27 +428,236 @@ _moveGameObjects()
     }
 
 
-    double dx = x - _gameObjects[i].x;
-    double dy = y - _gameObjects[i].y;
+    double dx = x - _gameObjects.x[i];
+    double dy = y - _gameObjects.y[i];
 
-    _gameObjects[i].x = x;
-    _gameObjects[i].y = y;
+    _gameObjects.x[i] = x;
+    _gameObjects.y[i] = y;
 
+    if (_gameObjects.sprite[i] == VOID_ID) {
+      continue;
+    }
     Graphic_TranslateSpriteFloat(
-      _gameObjects[i].sprite, 
+      _gameObjects.sprite[i], 
       -dy * TILE_HEIGHT + dx * TILE_HEIGHT,
       dy * TILE_HEIGHT / 2 + dx * TILE_HEIGHT / 2
     );
   }
 }
 
+static void
+_getGameObjectSprite(int i, Id* texture, SDL_Rect* src, SDL_Rect* dest)
+{
+  double x = _gameObjects.x[i];
+  double y = _gameObjects.y[i];
+  if (_gameObjects.slice[i] != NO_SLICE) {
+    // Bounds are relative to the instance, which is at the slice's origin.
+    const PrefabSlice* slice = &_prefabs.slices[_gameObjects.slice[i]];
+    x -= slice->x;
+    y -= slice->y;
+    *texture = slice->texture;
+    src->x = 0;
+    src->y = 0;
+    src->w = slice->bounds.w;
+    src->h = slice->bounds.h;
+    dest->x = lround((x - y) * (TILE_WIDTH / 2)) + slice->bounds.x;
+    dest->y = lround((x + y) * (TILE_HEIGHT / 2)) + slice->bounds.y;
+  } else {
+    const Tileset_Tile* tile = &_tiles[_gameObjects.tile[i]];
+    *texture = _spriteSheetId;
+    *src = tile->src;
+    dest->x = lround((x - y) * (TILE_WIDTH / 2)) - tile->anchor.x;
+    dest->y = lround((x + y) * (TILE_HEIGHT / 2) - _gameObjects.z[i])
+      - tile->anchor.y;
+  }
+  dest->w = src->w;
+  dest->h = src->h;
+}
+
+static SDL_Rect
+_growRect(SDL_Rect rect, int margin)
+{
+  rect.x -= margin;
+  rect.y -= margin;
+  rect.w += 2 * margin;
+  rect.h += 2 * margin;
+  return rect;
+}
+
+/* Range of chunks holding every object layer cell whose sprite may cross rect. */
+static void
+_queryTileObjectChunks(SDL_Rect rect, int* left, int* top, int* right, int* bottom)
+{
+  rect = _growRect(rect, _tileObjects.reach);
+
+  // Cell x, y is at (x - y) * TILE_WIDTH / 2, (x + y) * TILE_HEIGHT / 2.
+  double u0 = (double) rect.x / (TILE_WIDTH / 2);
+  double u1 = (double) (rect.x + rect.w) / (TILE_WIDTH / 2);
+  double v0 = (double) rect.y / (TILE_HEIGHT / 2);
+  double v1 = (double) (rect.y + rect.h) / (TILE_HEIGHT / 2);
+  int x0 = SDL_max(floor((u0 + v0) / 2), 0);
+  int y0 = SDL_max(floor((v0 - u1) / 2), 0);
+  int x1 = SDL_min(ceil((u1 + v1) / 2), _map.width - 1);
+  int y1 = SDL_min(ceil((v1 - u0) / 2), _map.height - 1);
+  *left = x0 >> TILEMAP_CHUNK_SHIFT;
+  *top = y0 >> TILEMAP_CHUNK_SHIFT;
+  *right = x1 < 0 ? -1 : x1 >> TILEMAP_CHUNK_SHIFT;
+  *bottom = y1 < 0 ? -1 : y1 >> TILEMAP_CHUNK_SHIFT;
+}
+
+static void
+_createTileObjectSprite(int x, int y, GameTiles tile, SDL_Rect dest)
+{
+  if (_tileObjects.total == _tileObjects.capacity) {
+    int capacity = SDL_max(2 * _tileObjects.capacity, 64);
+    SDL_Point* cells = realloc(_tileObjects.cells, capacity * sizeof(*cells));
+    if (cells == NULL) {
+      fprintf(stderr, "Couldn't allocate %d tile object sprites!\n", capacity);
+      exit(EXIT_FAILURE);
+    }
+    _tileObjects.cells = cells;
+    _tileObjects.capacity = capacity;
+  }
+
+  Id id = Graphic_CreateTilesetSprite(_spriteSheetId, _getTileSrc(tile), dest);
+  Tilemap_Set(&_map.tilesObjectSpriteId, x, y, id);
+  _tileObjects.cells[_tileObjects.total++] = (SDL_Point) { x, y };
+}
+
+/* Same as for game objects, for the cells of the object layer. */
+static void
+_updateTileObjectSprites(SDL_Rect view, SDL_Rect near, SDL_Rect far)
+{
+  if (!_tileObjects.rescan && SDL_RectEquals(&view, &_tileObjects.view)) {
+    return;
+  }
+  _tileObjects.rescan = false;
+  _tileObjects.view = view;
+
+  for (int i = _tileObjects.total; i-- > 0; ) {
+    SDL_Point cell = _tileObjects.cells[i];
+    GameTiles tile = Tilemap_Get(&_map.objectTiles, cell.x, cell.y);
+    SDL_Rect dest = _getObjectSpriteDest(tile, cell.x, cell.y, 0);
+    if (!SDL_HasIntersection(&dest, &far)) {
+      Graphic_DeleteSprite(Tilemap_Get(&_map.tilesObjectSpriteId, cell.x, cell.y));
+      Tilemap_Set(&_map.tilesObjectSpriteId, cell.x, cell.y, VOID_ID);
+      _tileObjects.cells[i] = _tileObjects.cells[--_tileObjects.total];
+      _spriteOrderDirty = true;
+    }
+  }
+
+  int left, top, right, bottom;
+  _queryTileObjectChunks(near, &left, &top, &right, &bottom);
+  for (int cy = top; cy <= bottom; cy++) {
+    for (int cx = left; cx <= right; cx++) {
+      const unsigned int* cells = Tilemap_QueryChunk(&_map.objectTiles, cx, cy);
+      if (cells == NULL) {
+        continue;
+      }
+
+      int right = SDL_min((cx + 1) * TILEMAP_CHUNK_SIZE, _map.width);
+      int bottom = SDL_min((cy + 1) * TILEMAP_CHUNK_SIZE, _map.height);
+      for (int y = cy * TILEMAP_CHUNK_SIZE; y < bottom; y++) {
+        for (int x = cx * TILEMAP_CHUNK_SIZE; x < right; x++) {
+          GameTiles tile = cells[(y & TILEMAP_CHUNK_MASK) << TILEMAP_CHUNK_SHIFT 
+            | (x & TILEMAP_CHUNK_MASK)];
+          if (tile == GameTile_Empty 
+              || Tilemap_Get(&_map.tilesObjectSpriteId, x, y) != VOID_ID) {
+            continue;
+          }
+          SDL_Rect dest = _getObjectSpriteDest(tile, x, y, 0);
+          if (SDL_HasIntersection(&dest, &near)) {
+            _createTileObjectSprite(x, y, tile, dest);
+            _spriteOrderDirty = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+static int
+_compareCells(const void* a, const void* b)
+{
+  const SDL_Point* first = a;
+  const SDL_Point* second = b;
+  if (first->y != second->y) {
+    return first->y < second->y ? -1 : 1;
+  }
+  return (first->x > second->x) - (first->x < second->x);
+}
+
+static void
+_putSpriteAfter(Id sprite, Id* previous)
+{
+  if (*previous != VOID_ID) {
+    Graphic_SetSpriteToBeAfterAnother(sprite, *previous);
+  }
+  *previous = sprite;
+}
+
+/*
+ * Gives sprites to the objects coming into view and takes them back from
+ * the ones leaving it, then puts the sprites back in order: the object
+ * layer's in map order, below the objects' in theirs.
+ */
+static void
+_updateGameObjectSprites()
+{
+  SDL_Rect view;
+  Graphic_QueryCameraView(&view);
+  SDL_Rect near = _growRect(view, VIEW_MARGIN);
+  SDL_Rect far = _growRect(view, 2 * VIEW_MARGIN);
+  _updateTileObjectSprites(view, near, far);
+
+  for (int i = 0; i < _activeGameObjects; i++) {
+    Id texture;
+    SDL_Rect src, dest;
+    _getGameObjectSprite(i, &texture, &src, &dest);
+
+    if (_gameObjects.sprite[i] == VOID_ID) {
+      if (SDL_HasIntersection(&dest, &near)) {
+        _gameObjects.sprite[i] = Graphic_CreateTilesetSprite(texture, src, dest);
+        if (_gameObjects.slice[i] == NO_SLICE) {
+          _playTile(_gameObjects.sprite[i], _gameObjects.tile[i]);
+        }
+        _spriteOrderDirty = true;
+      }
+    } else if (!SDL_HasIntersection(&dest, &far)) {
+      Graphic_DeleteSprite(_gameObjects.sprite[i]);
+      _gameObjects.sprite[i] = VOID_ID;
+      _spriteOrderDirty = true;
+    }
+  }
+
+  if (!_spriteOrderDirty) {
+    return;
+  }
+  Id previous = VOID_ID;
+  qsort(_tileObjects.cells, _tileObjects.total, sizeof(SDL_Point), _compareCells);
+  for (int i = 0; i < _tileObjects.total; i++) {
+    SDL_Point cell = _tileObjects.cells[i];
+    _putSpriteAfter(Tilemap_Get(&_map.tilesObjectSpriteId, cell.x, cell.y), &previous);
+  }
+  for (int i = 0; i < _activeGameObjects; i++) {
+    if (_gameObjects.sprite[i] != VOID_ID) {
+      _putSpriteAfter(_gameObjects.sprite[i], &previous);
+    }
+  }
+  _spriteOrderDirty = false;
+}
+
 static void 
 _update(void)
 {
   double zoom = Graphic_GetCameraZoom();
   if (Input_IsQuitPressed()) {
-    Graphic_Clear();
-    MainMenu_Enter();
+    Scene_Pop();
+    return;
+  } else if (Input_IsKeyReleased(SDLK_F5)) {
+    Game_Save(GAME_SAVE_FILE);
+  } else if (Input_IsKeyReleased(SDLK_F9)) {
+    Game_Load(GAME_SAVE_FILE);
     return;
   } else if (Input_IsKeyReleased(SDLK_EQUALS) && zoom < 5) {
     Graphic_ZoomSprites((zoom + 1.0) / zoom);
@@ -814,39 +667,13 @@ _update(void)
     _pause = !_pause;
   }
 
+  _handleCamera();
   if (!_pause) {
     Game_UpdateSimulation();
+  } else {
+    // The camera still moves while paused.
+    _updateGameObjectSprites();
   }
-  _handleCamera();
-}
-
-static void
-_createSpriteForTile(int x, int y)
-{
-  SDL_Rect src = _getTileSrc(_groundTiles[y][x]);
-  SDL_Rect dest = _getTileDest(src, x, y);
-  
-  _tilesSpriteId[y][x] = Graphic_CreateTilesetSprite(
-      _spriteSheetId, 
-      src, 
-      dest
-  );
-}
-
-static void
-_createSpriteForTileObject(int x, int y)
-{
-  if (_objectTiles[y][x] == GameTile_Empty) {
-    return;
-  }
-  SDL_Rect src = _getTileSrc(_objectTiles[y][x]);
-  SDL_Rect dest = _getObjectSpriteDest(src, x, y, 0);
-
-  _tilesObjectSpriteId[y][x] = Graphic_CreateTilesetSprite(
-      _spriteSheetId, 
-      src, 
-      dest
-  );
 }
 
 static void
@@ -860,31 +687,28 @@ _createGameObject(
     double dz,
     int i)
 {
-  SDL_Rect src = _getTileSrc(tile);
-  SDL_Rect dest = _getObjectSpriteDest(src, x, y, z);
-  _gameObjects[i].tile = tile;
-  _gameObjects[i].x = x;
-  _gameObjects[i].y = y;
-  _gameObjects[i].z = z;
-  _gameObjects[i].dx = dx;
-  _gameObjects[i].dy = dy;
-  _gameObjects[i].dz = dz;
-  _gameObjects[i].sprite = Graphic_CreateTilesetSprite(
-      _spriteSheetId, 
-      src, 
-      dest
-  );
-  _gameObjects[i].path = NoPath;
+  _gameObjects.tile[i] = tile;
+  _gameObjects.x[i] = x;
+  _gameObjects.y[i] = y;
+  _gameObjects.z[i] = z;
+  _gameObjects.dx[i] = dx;
+  _gameObjects.dy[i] = dy;
+  _gameObjects.dz[i] = dz;
+  _gameObjects.sprite[i] = VOID_ID;
+  _gameObjects.path[i] = NoPath;
+  _gameObjects.slice[i] = NO_SLICE;
 }
 
 static void
 _createCustomer(Path path, int i)
 {
-  _gameObjects[i].path = path;
-  _gameObjects[i].dy = 0;
-  _gameObjects[i].dx = 0;
-  _gameObjects[i].z = 0;
-  _gameObjects[i].dz = 0;
+  _gameObjects.path[i] = path;
+  _gameObjects.slice[i] = NO_SLICE;
+  _gameObjects.sprite[i] = VOID_ID;
+  _gameObjects.dy[i] = 0;
+  _gameObjects.dx[i] = 0;
+  _gameObjects.z[i] = 0;
+  _gameObjects.dz[i] = 0;
   switch(path) {
     case SouthToNorthOnWestSide:
     case SouthOnWestSideToWestOnSouthSide:
@@ -892,9 +716,9 @@ _createCustomer(Path path, int i)
     case SouthToNorthOnEastSide:
     case SouthOnEastSideToWestOnSouthSide:
     case SouthOnEastSideToWestOnNorthSide:
-      _gameObjects[i].tile = GameTile_WalkingCharacterNorth1;
-      _gameObjects[i].dy = -0.05;
-      _gameObjects[i].y = MAP_HEIGHT;
+      _gameObjects.tile[i] = GameTile_WalkingCharacterNorth1;
+      _gameObjects.dy[i] = -0.05;
+      _gameObjects.y[i] = _map.height;
       break;
     case NorthToSouthOnWestSide:
     case NorthToSouthOnEastSide:
@@ -902,9 +726,9 @@ _createCustomer(Path path, int i)
     case NorthOnEastSideToWestOnSouthSide:
     case NorthOnWestSideToWestOnNorthSide:
     case NorthOnEastSideToWestOnNorthSide:
-      _gameObjects[i].tile = GameTile_WalkingCharacterSouth1;
-      _gameObjects[i].dy = 0.05;
-      _gameObjects[i].y = 0;
+      _gameObjects.tile[i] = GameTile_WalkingCharacterSouth1;
+      _gameObjects.dy[i] = 0.05;
+      _gameObjects.y[i] = 0;
       break;
     case WestOnSouthSideToSouthOnWestSide:
     case WestOnSouthSideToSouthOnEastSide:
@@ -914,9 +738,9 @@ _createCustomer(Path path, int i)
     case WestOnNorthSideToSouthOnEastSide:
     case WestOnNorthSideToNorthOnWestSide:
     case WestOnNorthSideToNorthOnEastSide:
-      _gameObjects[i].tile = GameTile_WalkingCharacterEast1;
-      _gameObjects[i].dx = 0.05;
-      _gameObjects[i].x = 0;
+      _gameObjects.tile[i] = GameTile_WalkingCharacterEast1;
+      _gameObjects.dx[i] = 0.05;
+      _gameObjects.x[i] = 0;
       break;
   }
 
@@ -924,309 +748,766 @@ _createCustomer(Path path, int i)
     case SouthToNorthOnWestSide:
     case SouthOnWestSideToWestOnSouthSide:
     case SouthOnWestSideToWestOnNorthSide:
-      _gameObjects[i].x = SOUTH_TO_NORTH_WEST_SIDE_LANE;
+      _gameObjects.x[i] = SOUTH_TO_NORTH_WEST_SIDE_LANE;
       break;
     case SouthToNorthOnEastSide:
     case SouthOnEastSideToWestOnSouthSide:
     case SouthOnEastSideToWestOnNorthSide:
-      _gameObjects[i].x = SOUTH_TO_NORTH_EAST_SIDE_LANE;
+      _gameObjects.x[i] = SOUTH_TO_NORTH_EAST_SIDE_LANE;
       break;
     case NorthToSouthOnWestSide:
     case NorthOnWestSideToWestOnSouthSide:
     case NorthOnWestSideToWestOnNorthSide:
-      _gameObjects[i].x = NORTH_TO_SOUTH_WEST_SIDE_LANE;
+      _gameObjects.x[i] = NORTH_TO_SOUTH_WEST_SIDE_LANE;
       break;
     case NorthOnEastSideToWestOnSouthSide:
     case NorthToSouthOnEastSide:
     case NorthOnEastSideToWestOnNorthSide:
-      _gameObjects[i].x = NORTH_TO_SOUTH_EAST_SIDE_LANE;
+      _gameObjects.x[i] = NORTH_TO_SOUTH_EAST_SIDE_LANE;
       break;
     case WestOnSouthSideToSouthOnWestSide:
     case WestOnSouthSideToSouthOnEastSide:
     case WestOnSouthSideToNorthOnWestSide:
     case WestOnSouthSideToNorthOnEastSide:
-      _gameObjects[i].y = EAST_TO_WEST_SOUTH_SIDE_LANE;
+      _gameObjects.y[i] = EAST_TO_WEST_SOUTH_SIDE_LANE;
       break;
     case WestOnNorthSideToSouthOnWestSide:
     case WestOnNorthSideToSouthOnEastSide:
     case WestOnNorthSideToNorthOnWestSide:
     case WestOnNorthSideToNorthOnEastSide:
-      _gameObjects[i].y = EAST_TO_WEST_NORTH_SIDE_LANE;
+      _gameObjects.y[i] = EAST_TO_WEST_NORTH_SIDE_LANE;
       break;
   }
 }
 
 static void
-_createCustomerSprites()
+_createGroundLayer()
 {
-  for (int i = 0; i < _activeGameObjects; i++) {
-    SDL_Rect src, dest;
-    src = _getTileSrc(_gameObjects[i].tile);
-    dest = _getObjectSpriteDest(src, _gameObjects[i].x, _gameObjects[i].y, _gameObjects[i].z);
+  SDL_Rect palette[TotalGameTiles];
+  for (int tile = 0; tile < TotalGameTiles; tile++) {
+    palette[tile] = _getTileSrc(tile);
+  }
 
-    _gameObjects[i].sprite = Graphic_CreateTilesetSprite(
-      _spriteSheetId, 
-      src, 
-      dest
-    );
+  Id layer = _groundLayer = Graphic_CreateTileLayer(
+      _spriteSheetId,
+      Graphic_IsometricTiles,
+      _map.width,
+      _map.height,
+      TILE_WIDTH,
+      TILE_HEIGHT,
+      palette,
+      TotalGameTiles
+  );
+
+  SmallId tiles[TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE];
+  int chunksWide = (_map.width + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+  int chunksHigh = (_map.height + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+  for (int cy = 0; cy < chunksHigh; cy++) {
+    for (int cx = 0; cx < chunksWide; cx++) {
+      const unsigned int* cells = Tilemap_QueryChunk(&_map.groundTiles, cx, cy);
+      if (cells == NULL) {
+        continue;
+      }
+
+      for (int i = 0; i < TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE; i++) {
+        tiles[i] = cells[i];
+      }
+      int left = cx * TILEMAP_CHUNK_SIZE;
+      int top = cy * TILEMAP_CHUNK_SIZE;
+      Graphic_SetTileLayerTiles(
+          layer, 
+          left, 
+          top, 
+          SDL_min(TILEMAP_CHUNK_SIZE, _map.width - left),
+          SDL_min(TILEMAP_CHUNK_SIZE, _map.height - top),
+          tiles,
+          TILEMAP_CHUNK_SIZE
+      );
+    }
   }
 }
 
 static void
-_createMapSprite()
+_createClips()
 {
-  Sprite mapSprites[MAP_HEIGHT][MAP_WIDTH] = {0};
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      mapSprites[y][x].src = _getTileSrc(GameTile_Grass);
-      mapSprites[y][x].textureId = _spriteSheetId;
+  SDL_Rect frames[TotalGameTiles];
+  for (int tile = 0; tile < TotalGameTiles; tile++) {
+    _clips[tile] = VOID_ID;
+    if (_tiles[tile].next == (GameTiles) tile) {
+      continue;
     }
+
+    // Frames run until they loop back to the tile, or to another frame.
+    int totalFrames = 0;
+    GameTiles frame = tile;
+    do {
+      frames[totalFrames++] = _tiles[frame].src;
+      frame = _tiles[frame].next;
+    } while (frame != (GameTiles) tile && totalFrames < TotalGameTiles);
+    _clips[tile] = Graphic_CreateClip(frames, totalFrames, ANIMATION_TICKS);
   }
+}
 
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = SOUTH_TO_NORTH_WEST_SIDE_LANE + 1; x < NORTH_TO_SOUTH_EAST_SIDE_LANE; x++) {
-      mapSprites[y][x].src = _getTileSrc(GameTile_Road);
+static void
+_bakePrefabSlices()
+{
+  Arena* arena = Arena_GetFrame();
+  Arena_Mark mark = Arena_GetMark(arena);
+  for (int i = 0; i < _prefabs.totalSlices; i++) {
+    PrefabSlice* slice = &_prefabs.slices[i];
+    Sprite* sprites = ARENA_ALLOC_ARRAY(arena, Sprite, slice->totalObjects);
+    for (int j = 0; j < slice->totalObjects; j++) {
+      const Level_Object* object = &_prefabs.objects[slice->firstObject + j];
+      sprites[j].textureId = _spriteSheetId;
+      sprites[j].src = _getTileSrc(object->tile);
+      sprites[j].dest = _getObjectSpriteDest(
+          object->tile, 
+          object->x, 
+          object->y, 
+          object->z
+      );
     }
+    slice->texture = Graphic_CreateTextureFromSprites(
+        sprites, 
+        sprites + slice->totalObjects,
+        &slice->bounds
+    );
+    Arena_ResetTo(arena, mark);
   }
+}
 
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    mapSprites[y][NORTH_TO_SOUTH_WEST_SIDE_LANE].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[y][SOUTH_TO_NORTH_WEST_SIDE_LANE].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[y][NORTH_TO_SOUTH_EAST_SIDE_LANE].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[y][SOUTH_TO_NORTH_EAST_SIDE_LANE].src = _getTileSrc(GameTile_SideWalk);
+/*
+ * Sprites are only created once the whole state is in place, whether it
+ * came from a level or a save. Objects, and the object layer's cells, get
+ * theirs from _updateGameObjectSprites once the camera is in place.
+ */
+static void
+_createSprites()
+{
+  _createGroundLayer();
+  _createClips();
+  _bakePrefabSlices();
+  _tileObjects.rescan = true;
+  for (int i = 0; i < _activeGameObjects; i++) {
+    _gameObjects.sprite[i] = VOID_ID;
   }
+}
 
-  for (int y = WEST_TO_EAST_NORTH_SIDE_LANE + 1; y < EAST_TO_WEST_SOUTH_SIDE_LANE; y++) {
-    mapSprites[y][NORTH_TO_SOUTH_WEST_SIDE_LANE].src = _getTileSrc(GameTile_CrosswalkNorthSouth1);
-    mapSprites[y][SOUTH_TO_NORTH_WEST_SIDE_LANE].src = _getTileSrc(GameTile_CrosswalkNorthSouth2);
+/* For when the scene that owns what _createSprites made releases it. */
+static void
+_forgetSprites()
+{
+  for (int i = 0; i < _activeGameObjects; i++) {
+    _gameObjects.sprite[i] = VOID_ID;
+  }
+  for (int i = 0; i < _tileObjects.total; i++) {
+    SDL_Point cell = _tileObjects.cells[i];
+    Tilemap_Set(&_map.tilesObjectSpriteId, cell.x, cell.y, VOID_ID);
   }
+  _tileObjects.total = 0;
+  _tileObjects.rescan = true;
+  for (int i = 0; i < _prefabs.totalSlices; i++) {
+    _prefabs.slices[i].texture = VOID_ID;
+  }
+  for (int tile = 0; tile < TotalGameTiles; tile++) {
+    _clips[tile] = VOID_ID;
+  }
+  _groundLayer = VOID_ID;
+  _spriteSheetId = VOID_ID;
+}
 
-  for (int x = SOUTH_TO_NORTH_WEST_SIDE_LANE + 1; x < NORTH_TO_SOUTH_EAST_SIDE_LANE; x++) {
-    mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE][x].src = _getTileSrc(GameTile_CrosswalkEastWest2);
-    mapSprites[WEST_TO_EAST_NORTH_SIDE_LANE][x].src = _getTileSrc(GameTile_CrosswalkEastWest1);
-    mapSprites[EAST_TO_WEST_SOUTH_SIDE_LANE][x].src = _getTileSrc(GameTile_CrosswalkEastWest2);
-    mapSprites[WEST_TO_EAST_SOUTH_SIDE_LANE][x].src = _getTileSrc(GameTile_CrosswalkEastWest1);
+/*
+ * Releases what _createSprites made, leaving the textures and sprites of
+ * other scenes alone. Everything drawn from the sprite sheet goes with it.
+ */
+static void
+_destroySprites()
+{
+  if (_spriteSheetId == VOID_ID) {
+    return;
   }
 
-  for (int x = 0; x < NORTH_TO_SOUTH_WEST_SIDE_LANE;  x++) {
-    for (int y = WEST_TO_EAST_NORTH_SIDE_LANE + 1; y < EAST_TO_WEST_SOUTH_SIDE_LANE; y++) {
-      mapSprites[y][x].src = _getTileSrc(GameTile_Road);
+  // Prefab slices are textures of their own.
+  for (int i = 0; i < _activeGameObjects; i++) {
+    if (_gameObjects.sprite[i] != VOID_ID) {
+      Graphic_DeleteSprite(_gameObjects.sprite[i]);
+    }
+  }
+  for (int i = 0; i < _prefabs.totalSlices; i++) {
+    if (_prefabs.slices[i].texture != VOID_ID) {
+      Graphic_DeleteTexture(_prefabs.slices[i].texture);
     }
-    mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE][x].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[WEST_TO_EAST_NORTH_SIDE_LANE][x].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[EAST_TO_WEST_SOUTH_SIDE_LANE][x].src = _getTileSrc(GameTile_SideWalk);
-    mapSprites[WEST_TO_EAST_SOUTH_SIDE_LANE][x].src = _getTileSrc(GameTile_SideWalk);
   }
+  for (int tile = 0; tile < TotalGameTiles; tile++) {
+    if (_clips[tile] != VOID_ID) {
+      Graphic_DeleteClip(_clips[tile]);
+    }
+  }
+  Graphic_DeleteTileLayer(_groundLayer);
+  Graphic_DeleteTexture(_spriteSheetId);
+  _forgetSprites();
+}
 
-  mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE - 1][NORTH_TO_SOUTH_WEST_SIDE_LANE - 8].src = _getTileSrc(GameTile_NorthToSouthEntryWalkway);
-  mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE - 2][NORTH_TO_SOUTH_WEST_SIDE_LANE - 8].src = _getTileSrc(GameTile_NorthToSouthEntryWalkway);
-  mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE - 3][NORTH_TO_SOUTH_WEST_SIDE_LANE - 8].src = _getTileSrc(GameTile_NorthToSouthEntryWalkway);
-  mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE - 4][NORTH_TO_SOUTH_WEST_SIDE_LANE - 8].src = _getTileSrc(GameTile_NorthToSouthEntryWalkway);
-  mapSprites[EAST_TO_WEST_NORTH_SIDE_LANE - 5][NORTH_TO_SOUTH_WEST_SIDE_LANE - 8].src = _getTileSrc(GameTile_NorthToSouthEntryWalkway);
+// Level chunks are copied as they are into the tilemaps.
+_Static_assert(LEVEL_CHUNK_SIZE == TILEMAP_CHUNK_SIZE, "chunk sizes differ");
 
-  for (int x = 0; x < MAP_WIDTH; x++) {
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-      mapSprites[y][x].dest = _getTileDest(mapSprites[y][x].src, x, y);
+static void
+_loadChunk(int cx, int cy, const uint16_t* ground, const uint16_t* objects)
+{
+  if (ground) {
+    unsigned int* cells = Tilemap_AcquireChunk(&_map.groundTiles, cx, cy);
+    for (int i = 0; i < LEVEL_CHUNK_CELLS; i++) {
+      cells[i] = ground[i];
+    }
+  }
+  if (objects) {
+    unsigned int* cells = Tilemap_AcquireChunk(&_map.objectTiles, cx, cy);
+    for (int i = 0; i < LEVEL_CHUNK_CELLS; i++) {
+      cells[i] = objects[i];
     }
   }
-
-  Graphic_CreateSpriteFromSprites(
-      (Sprite*) mapSprites, 
-      (Sprite*) mapSprites[MAP_WIDTH]
-  );
 }
 
 static void
-_createHouse(int x, int y)
+_loadTiles(const Level* level)
 {
-  _createGameObject(GameTile_LeftHouseCorner, x, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Wall, x + 1, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseDoor, x + 2, y, 0, 0, 0, 0,  _activeGameObjects++);
-  _createGameObject(GameTile_Wall, x + 3, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Wall, x + 4, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Wall, x + 5, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Wall, x + 6, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_RightHouseCorner, x + 7, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRightWallFirstSection, x + 7, y - 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRightWallCenterSection, x + 7, y - 2, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRightWallThirdSection, x + 7, y - 3, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRightWallLastSection, x + 7, y - 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 6, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 5, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 4, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 3, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 2, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopRoof, x + 1, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseTopLeftRoof, x, y - 2, 7 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseLeftRoof, x, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 6, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 5, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 4, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 3, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 2, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_HouseRoof, x + 1, y - 1, 5.5 * TILE_HEIGHT, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 1, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_FrontPorchStair, x + 2, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 3, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 4, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 5, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 6, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_Bush, x + 7, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y + 3, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y + 2, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y - 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y - 2, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y - 3, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_NorthToSouthFence, x - 4, y - 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToNorthFenceCorner, x - 4, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x - 3, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x - 2, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x - 1, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 1, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFenceEntrance, x + 2, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 3, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 4, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 5, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 6, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_EastToWestFence, x + 7, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_WestToNorthFenceCorner, x + 8, y + 4, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y + 3, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y + 2, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y + 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y - 1, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y - 2, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y - 3, 0, 0, 0, 0, _activeGameObjects++);
-  _createGameObject(GameTile_SouthToNorthFence, x + 8, y - 4, 0, 0, 0, 0, _activeGameObjects++);
+  for (uint32_t i = 0; i < level->header->totalChunks; i++) {
+    const Level_Chunk* chunk = &level->chunks[i];
+    _loadChunk(
+        chunk->x, 
+        chunk->y, 
+        Level_GetCells(level, chunk->groundOffset),
+        Level_GetCells(level, chunk->objectOffset)
+    );
+  }
 }
 
-static void
-_createFirstLevel()
+static int
+_getPrefabRow(const Level_Object* object)
 {
-  _activeGameObjects = 0;
-  _spriteSheetId = Graphic_LoadTexture("sprite-sheet2.bmp");
+  return floor(object->y);
+}
 
-  int w, h;
-  Graphic_QueryWindowSize(&w, &h);
+/* Orders objects by row, then from west to east and from bottom to top. */
+static bool
+_isPrefabObjectBefore(const Level_Object* a, const Level_Object* b)
+{
+  if (_getPrefabRow(a) != _getPrefabRow(b)) {
+    return _getPrefabRow(a) < _getPrefabRow(b);
+  }
+  if (a->x != b->x) {
+    return a->x < b->x;
+  }
+  return a->z < b->z;
+}
 
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      _objectTiles[y][x] = GameTile_Empty;
+static int
+_countPrefabSlices(const Level_Prefab* prefab, const Level_Object* objects)
+{
+  int total = 0;
+  for (uint32_t i = 0; i < prefab->totalObjects; i++) {
+    int row = _getPrefabRow(&objects[prefab->firstObject + i]);
+    uint32_t j = 0;
+    while (j < i && _getPrefabRow(&objects[prefab->firstObject + j]) != row) {
+      j++;
     }
+    total += j == i;
+  }
+  return total;
+}
+
+static bool
+_checkPrefabs(const char* filename, uint32_t totalPrefabs, uint32_t totalObjects)
+{
+  if (totalPrefabs > MAX_PREFABS || totalObjects > MAX_PREFAB_OBJECTS) {
+    fprintf(stderr, "%s has too many prefabs!\n", filename);
+    return false;
   }
+  return true;
+}
 
-  _objectTiles[STAND_Y][STAND_X] = GameTile_Stand;
+static void
+_loadPrefabs(
+    const Level_Prefab* prefabs, 
+    uint32_t totalPrefabs, 
+    const Level_Object* objects, 
+    uint32_t totalObjects
+)
+{
+  _prefabs.totalPrefabs = totalPrefabs;
+  _prefabs.totalObjects = totalObjects;
+  _prefabs.totalSlices = 0;
+  memcpy(_prefabs.prefabs, prefabs, totalPrefabs * sizeof(*prefabs));
+  memcpy(_prefabs.objects, objects, totalObjects * sizeof(*objects));
 
+  for (int i = 0; i < _prefabs.totalPrefabs; i++) {
+    const Level_Prefab* prefab = &_prefabs.prefabs[i];
+    Level_Object* first = &_prefabs.objects[prefab->firstObject];
 
-  _createMapSprite();
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      _createSpriteForTileObject(x, y);
+    // Stable insertion sort, so objects on the same spot keep their order.
+    for (uint32_t j = 1; j < prefab->totalObjects; j++) {
+      Level_Object object = first[j];
+      uint32_t k = j;
+      for (; k > 0 && _isPrefabObjectBefore(&object, &first[k - 1]); k--) {
+        first[k] = first[k - 1];
+      }
+      first[k] = object;
+    }
+
+    _prefabs.firstSlice[i] = _prefabs.totalSlices;
+    _prefabs.sliceCounts[i] = 0;
+    for (uint32_t j = 0; j < prefab->totalObjects; j++) {
+      if (j > 0 && _getPrefabRow(&first[j]) == _getPrefabRow(&first[j - 1])) {
+        _prefabs.slices[_prefabs.totalSlices - 1].totalObjects++;
+        continue;
+      }
+
+      _prefabs.sliceCounts[i]++;
+      PrefabSlice* slice = &_prefabs.slices[_prefabs.totalSlices++];
+      slice->prefab = i;
+      slice->firstObject = prefab->firstObject + j;
+      slice->totalObjects = 1;
+      slice->x = first[j].x;
+      slice->y = _getPrefabRow(&first[j]);
+      slice->texture = VOID_ID;
     }
   }
+}
 
-  _createCustomer(NorthToSouthOnWestSide, _activeGameObjects++);
-  _createCustomer(SouthToNorthOnWestSide, _activeGameObjects++);
-  _createCustomer(NorthToSouthOnEastSide, _activeGameObjects++);
-  _createCustomer(SouthToNorthOnEastSide, _activeGameObjects++);
-  _createCustomer(WestOnNorthSideToNorthOnWestSide, _activeGameObjects++);
-  _createCustomer(WestOnNorthSideToSouthOnWestSide, _activeGameObjects++);
-  _createCustomer(WestOnNorthSideToNorthOnEastSide, _activeGameObjects++);
-  _createCustomer(WestOnNorthSideToSouthOnEastSide, _activeGameObjects++);
-  _createCustomer(WestOnSouthSideToNorthOnWestSide, _activeGameObjects++);
-  _createCustomer(WestOnSouthSideToSouthOnWestSide, _activeGameObjects++);
-  _createCustomer(WestOnSouthSideToNorthOnEastSide, _activeGameObjects++);
-  _createCustomer(WestOnSouthSideToSouthOnEastSide, _activeGameObjects++);
-  _createCustomer(SouthOnEastSideToWestOnNorthSide, _activeGameObjects++);
-  _createCustomer(SouthOnEastSideToWestOnSouthSide, _activeGameObjects++);
-  _createCustomer(SouthOnWestSideToWestOnNorthSide, _activeGameObjects++);
-  _createCustomer(SouthOnWestSideToWestOnSouthSide, _activeGameObjects++);
-  _createCustomer(NorthOnEastSideToWestOnNorthSide, _activeGameObjects++);
-  _createCustomer(NorthOnEastSideToWestOnSouthSide, _activeGameObjects++);
-  _createCustomer(NorthOnWestSideToWestOnNorthSide, _activeGameObjects++);
-  _createCustomer(NorthOnWestSideToWestOnSouthSide, _activeGameObjects++);
-  _createCustomerSprites();
-  _createGameObject(
-      GameTile_StopSignFacingWest, 
-      NORTH_TO_SOUTH_WEST_SIDE_LANE - 1,
-      WEST_TO_EAST_SOUTH_SIDE_LANE + 1,
-      0,
-      0,
-      0,
-      0,
-      _activeGameObjects++
-  );
-  _createGameObject(
-      GameTile_StopSignFacingSouth, 
-      SOUTH_TO_NORTH_EAST_SIDE_LANE + 1,
-      WEST_TO_EAST_SOUTH_SIDE_LANE + 1,
-      0,
-      0,
-      0,
-      0,
-      _activeGameObjects++
-  );
-  _createGameObject(
-      GameTile_StopSignFacingNorth,
-      NORTH_TO_SOUTH_WEST_SIDE_LANE - 1,
-      EAST_TO_WEST_NORTH_SIDE_LANE - 1,
-      0,
-      0,
-      0,
-      0,
-      _activeGameObjects++
-  );
+static void
+_createPrefabInstance(const Level_Instance* instance)
+{
+  int first = _prefabs.firstSlice[instance->prefab];
+  int total = _prefabs.sliceCounts[instance->prefab];
+  assert(_activeGameObjects + total <= MAX_GAME_OBJECTS);
+
+  for (int i = first; i < first + total; i++) {
+    int object = _activeGameObjects++;
+    _createGameObject(
+        GameTile_Empty,
+        instance->x + _prefabs.slices[i].x,
+        instance->y + _prefabs.slices[i].y,
+        0,
+        0,
+        0,
+        0,
+        object
+    );
+    _gameObjects.slice[object] = i;
+  }
+}
+
+static void
+_createLevelObject(const Level_Object* object)
+{
+  assert(_activeGameObjects < MAX_GAME_OBJECTS);
   _createGameObject(
-      GameTile_Bush,
-      SOUTH_TO_NORTH_EAST_SIDE_LANE + 1,
-      EAST_TO_WEST_NORTH_SIDE_LANE - 2,
-      0,
-      0,
-      0,
-      0,
+      object->tile, 
+      object->x, 
+      object->y, 
+      object->z, 
+      0, 
+      0, 
+      0, 
       _activeGameObjects++
   );
+}
+
+static void
+_initMap()
+{
+  Tilemap_Free(&_map.groundTiles);
+  Tilemap_Free(&_map.objectTiles);
+  Tilemap_Free(&_map.tilesObjectSpriteId);
+  Tilemap_Init(&_map.groundTiles, _map.width, _map.height, GameTile_Empty);
+  Tilemap_Init(&_map.objectTiles, _map.width, _map.height, GameTile_Empty);
+  Tilemap_Init(&_map.tilesObjectSpriteId, _map.width, _map.height, VOID_ID);
+}
 
-  _createHouse(
-      NORTH_TO_SOUTH_WEST_SIDE_LANE - 10,
-      EAST_TO_WEST_NORTH_SIDE_LANE - 6
+/* Only reads the files, so it runs on any thread. */
+static bool
+_readLevel(const char* filename, Level* level, Tileset_Tile tiles[TotalGameTiles])
+{
+  if (!Tileset_Load(tiles, TILESET, TILE_HEIGHT)) {
+    return false;
+  }
+  if (!Level_Open(level, filename)) {
+    return false;
+  }
+  if (!_checkPrefabs(
+        filename, 
+        level->header->totalPrefabs, 
+        level->header->totalPrefabObjects
+  )) {
+    Level_Close(level);
+    return false;
+  }
+
+  // Once _createLevel has destroyed the current level, it can't fail.
+  int sliceCounts[MAX_PREFABS];
+  for (uint32_t i = 0; i < level->header->totalPrefabs; i++) {
+    sliceCounts[i] = _countPrefabSlices(&level->prefabs[i], level->prefabObjects);
+  }
+  uint64_t totalObjects = (uint64_t) level->header->totalSpawns
+    + level->header->totalObjects;
+  for (uint32_t i = 0; i < level->header->totalInstances; i++) {
+    totalObjects += sliceCounts[level->instances[i].prefab];
+  }
+  if (totalObjects > MAX_GAME_OBJECTS) {
+    fprintf(stderr, "Level %s has too many objects!\n", filename);
+    Level_Close(level);
+    return false;
+  }
+  return true;
+}
+
+static void
+_setTiles(const Tileset_Tile tiles[TotalGameTiles])
+{
+  memcpy(_tiles, tiles, sizeof(_tiles));
+  // Sprites reach past their cell by at most their size and anchor.
+  _tileObjects.reach = 0;
+  for (int tile = 0; tile < TotalGameTiles; tile++) {
+    int w = _tiles[tile].src.w + abs(_tiles[tile].anchor.x);
+    int h = _tiles[tile].src.h + abs(_tiles[tile].anchor.y);
+    _tileObjects.reach = SDL_max(_tileObjects.reach, SDL_max(w, h));
+  }
+}
+
+/* Replaces the current level, and takes ownership of the sprite sheet. */
+static void
+_createLevel(const Level* level, const Tileset_Tile tiles[TotalGameTiles], Id spriteSheet)
+{
+  _destroySprites();
+  _spriteSheetId = spriteSheet;
+  _setTiles(tiles);
+  _activeGameObjects = 0;
+
+  _map.width = level->header->width;
+  _map.height = level->header->height;
+  for (int i = 0; i < TotalLanes; i++) {
+    _lanes[i] = level->lanes[i];
+  }
+
+  _loadPrefabs(
+      level->prefabs, 
+      level->header->totalPrefabs, 
+      level->prefabObjects, 
+      level->header->totalPrefabObjects
   );
+
+  _initMap();
+  _loadTiles(level);
+
+  for (uint32_t i = 0; i < level->header->totalSpawns; i++) {
+    _createCustomer(level->spawns[i], _activeGameObjects++);
+  }
+
+  for (uint32_t i = 0; i < level->header->totalObjects; i++) {
+    _createLevelObject(&level->objects[i]);
+  }
+
+  for (uint32_t i = 0; i < level->header->totalInstances; i++) {
+    _createPrefabInstance(&level->instances[i]);
+  }
+
+  _createSprites();
   _pause = false;
   Graphic_CenterCamera();
-  _dt = 0;
+  _updateGameObjectSprites();
 }
 
-void 
-Game_Enter(void)
+static const Scene _scene = { _update, NULL, NULL, _forgetSprites };
+
+static void
+_enterScene()
+{
+  if (Scene_GetCurrent() != &_scene) {
+    Scene_Push(&_scene);
+  }
+}
+
+static bool
+_preloadLevel(void* data)
+{
+  (void) data;
+  if (!_readLevel(_preload.filename, &_preload.level, _preload.tiles)) {
+    return false;
+  }
+
+  // Fault the mapping in now rather than while the level is built.
+  volatile unsigned char sum = 0;
+  for (size_t i = 0; i < _preload.level.size; i += 4096) {
+    sum += _preload.level.data[i];
+  }
+  return true;
+}
+
+static void
+_enterPreloadedLevel(void* data, bool loaded)
 {
+  (void) data;
+  if (!loaded) {
+    Level_Close(&_preload.level);
+    Graphic_DeleteTexture(_preload.spriteSheet);
+    return;
+  }
+
   _cameraDx = 0;
   _cameraDy = 0;
-  Scene_SetUpdateTo(_update);
+  _enterScene();
+  // Loaded while the previous scene was current.
+  Graphic_AdoptTexture(_preload.spriteSheet);
   Graphic_InitCamera();
-  _createFirstLevel();
+  _createLevel(&_preload.level, _preload.tiles, _preload.spriteSheet);
+  Level_Close(&_preload.level);
+}
+
+void 
+Game_Enter(void)
+{
+  // The sprite sheet is decoded alongside.
+  _preload.filename = _levelFilename;
+  _preload.spriteSheet = Graphic_LoadTextureAsync(SPRITE_SHEET);
+  if (!Scene_LoadInBackground(_preloadLevel, _enterPreloadedLevel, NULL)) {
+    Graphic_DeleteTexture(_preload.spriteSheet);
+  }
 }
 
 void
 Game_StartSimulation()
 {
-  _createFirstLevel();
+  // Decoded while the tileset and the level are read.
+  Id spriteSheet = Graphic_LoadTextureAsync(SPRITE_SHEET);
+  Level level;
+  Tileset_Tile tiles[TotalGameTiles];
+  if (!_readLevel(_levelFilename, &level, tiles)) {
+    exit(EXIT_FAILURE);
+  }
+  _createLevel(&level, tiles, spriteSheet);
+  Level_Close(&level);
 }
 
 void
 Game_UpdateSimulation()
 {
   _moveGameObjects();
-  if (_dt == 15) {
-    _dt -= 15;
-    _animateGameObjects();
-  } else {
-    _dt++;
-  }
   _reorderGameObjects();
+  _updateGameObjectSprites();
+  Graphic_AnimateSprites();
+}
+
+void
+Game_SetLevel(const char* filename)
+{
+  _levelFilename = filename;
+}
+
+// Object arrays are copied as they are into and out of saves.
+_Static_assert(sizeof(GameTiles) == sizeof(uint32_t), "tiles don't fit saves");
+_Static_assert(sizeof(Path) == sizeof(uint32_t), "paths don't fit saves");
+_Static_assert(sizeof(int) == sizeof(int32_t), "slices don't fit saves");
+
+void
+Game_Save(const char* filename)
+{
+  int chunksWide = (_map.width + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+  int chunksHigh = (_map.height + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+  uint32_t totalChunks = 0;
+  for (int cy = 0; cy < chunksHigh; cy++) {
+    for (int cx = 0; cx < chunksWide; cx++) {
+      totalChunks += 
+        Tilemap_QueryChunk(&_map.groundTiles, cx, cy) ||
+        Tilemap_QueryChunk(&_map.objectTiles, cx, cy);
+    }
+  }
+
+  // Only copy here, the worker thread packs and writes the copy.
+  Save_State* state = Save_CreateState(
+      _activeGameObjects, 
+      _prefabs.totalPrefabs, 
+      _prefabs.totalObjects, 
+      totalChunks
+  );
+  state->width = _map.width;
+  state->height = _map.height;
+  memcpy(state->lanes, _lanes, sizeof(state->lanes));
+  state->random = _random;
+
+  size_t n = _activeGameObjects;
+  memcpy(state->x, _gameObjects.x, n * sizeof(double));
+  memcpy(state->y, _gameObjects.y, n * sizeof(double));
+  memcpy(state->z, _gameObjects.z, n * sizeof(double));
+  memcpy(state->dx, _gameObjects.dx, n * sizeof(double));
+  memcpy(state->dy, _gameObjects.dy, n * sizeof(double));
+  memcpy(state->dz, _gameObjects.dz, n * sizeof(double));
+  memcpy(state->tiles, _gameObjects.tile, n * sizeof(uint32_t));
+  memcpy(state->paths, _gameObjects.path, n * sizeof(uint32_t));
+  memcpy(state->slices, _gameObjects.slice, n * sizeof(int32_t));
+  memcpy(
+      state->prefabs, 
+      _prefabs.prefabs, 
+      _prefabs.totalPrefabs * sizeof(Level_Prefab)
+  );
+  memcpy(
+      state->prefabObjects, 
+      _prefabs.objects, 
+      _prefabs.totalObjects * sizeof(Level_Object)
+  );
+
+  Save_Chunk* chunk = state->chunks;
+  size_t bytes = LEVEL_CHUNK_CELLS * sizeof(unsigned int);
+  for (int cy = 0; cy < chunksHigh; cy++) {
+    for (int cx = 0; cx < chunksWide; cx++) {
+      const unsigned int* ground = Tilemap_QueryChunk(&_map.groundTiles, cx, cy);
+      const unsigned int* objects = Tilemap_QueryChunk(&_map.objectTiles, cx, cy);
+      if (!ground && !objects) {
+        continue;
+      }
+
+      chunk->x = cx;
+      chunk->y = cy;
+      chunk->hasGround = ground != NULL;
+      chunk->hasObjects = objects != NULL;
+      if (ground) {
+        memcpy(chunk->ground, ground, bytes);
+      }
+      if (objects) {
+        memcpy(chunk->objects, objects, bytes);
+      }
+      chunk++;
+    }
+  }
+
+  Save_WriteAsync(state, filename);
 }
 
+bool
+Game_Load(const char* filename)
+{
+  Save_File file;
+  if (!Save_Open(&file, filename)) {
+    return false;
+  }
+  if (file.header->totalObjects > MAX_GAME_OBJECTS) {
+    fprintf(stderr, "Save %s has too many objects!\n", filename);
+    Save_Close(&file);
+    return false;
+  }
+  if (!_checkPrefabs(
+        filename, 
+        file.header->totalPrefabs, 
+        file.header->totalPrefabObjects
+  )) {
+    Save_Close(&file);
+    return false;
+  }
+
+  // Slices are rebuilt from the prefabs, so objects must match them.
+  int32_t totalSlices = 0;
+  for (uint32_t i = 0; i < file.header->totalPrefabs; i++) {
+    totalSlices += _countPrefabSlices(&file.prefabs[i], file.prefabObjects);
+  }
+  for (uint32_t i = 0; i < file.header->totalObjects; i++) {
+    if (file.slices[i] != NO_SLICE && file.slices[i] >= totalSlices) {
+      fprintf(stderr, "Save %s has an invalid prefab slice!\n", filename);
+      Save_Close(&file);
+      return false;
+    }
+  }
+
+  // The game may not have been entered yet, so the tiles may not be loaded.
+  Tileset_Tile tiles[TotalGameTiles];
+  if (!Tileset_Load(tiles, TILESET, TILE_HEIGHT)) {
+    Save_Close(&file);
+    return false;
+  }
+  _destroySprites();
+  _setTiles(tiles);
+
+  _cameraDx = 0;
+  _cameraDy = 0;
+  _enterScene();
+  Graphic_InitCamera();
+  _spriteSheetId = Graphic_LoadTextureAsync(SPRITE_SHEET);
+
+  const Save_Header* header = file.header;
+  _map.width = header->width;
+  _map.height = header->height;
+  memcpy(_lanes, header->lanes, sizeof(_lanes));
+  _random.state = header->randomState;
+  _random.increment = header->randomIncrement;
+
+  _loadPrefabs(
+      file.prefabs, 
+      header->totalPrefabs, 
+      file.prefabObjects, 
+      header->totalPrefabObjects
+  );
+
+  _initMap();
+  for (uint32_t i = 0; i < header->totalChunks; i++) {
+    const Level_Chunk* chunk = &file.chunks[i];
+    _loadChunk(
+        chunk->x, 
+        chunk->y, 
+        Save_GetCells(&file, chunk->groundOffset),
+        Save_GetCells(&file, chunk->objectOffset)
+    );
+  }
+
+  size_t n = _activeGameObjects = header->totalObjects;
+  memcpy(_gameObjects.x, file.x, n * sizeof(double));
+  memcpy(_gameObjects.y, file.y, n * sizeof(double));
+  memcpy(_gameObjects.z, file.z, n * sizeof(double));
+  memcpy(_gameObjects.dx, file.dx, n * sizeof(double));
+  memcpy(_gameObjects.dy, file.dy, n * sizeof(double));
+  memcpy(_gameObjects.dz, file.dz, n * sizeof(double));
+  memcpy(_gameObjects.tile, file.tiles, n * sizeof(uint32_t));
+  memcpy(_gameObjects.path, file.paths, n * sizeof(uint32_t));
+  memcpy(_gameObjects.slice, file.slices, n * sizeof(int32_t));
+  Save_Close(&file);
+
+  _createSprites();
+  _pause = false;
+  Graphic_CenterCamera();
+  _updateGameObjectSprites();
+  return true;
+}
+
+void
+Game_Seed(unsigned long long seed)
+{
+  Random_Seed(&_random, seed, 0);
+}
+
+void
+Game_SpawnCustomers(int count)
+{
+  for (int i = 0; i < count && _activeGameObjects < MAX_GAME_OBJECTS; i++) {
+    int object = _activeGameObjects++;
+    _createCustomer((Path) (1 + i % WestOnNorthSideToNorthOnEastSide), object);
+
+    // Every path starts at the edge of the map, so spread the customers
+    // along their lane instead of stacking them on one tile.
+    int round = Random_Range(&_random, _map.height);
+    _gameObjects.x[object] += _gameObjects.dx[object] * 20 * round;
+    _gameObjects.y[object] += _gameObjects.dy[object] * 20 * round;
+  }
+}
+
+int
+Game_CountActors()
+{
+  return _activeGameObjects;
+}
+
+int
+Game_CountSprites()
+{
+  int total = 0;
+  for (int i = 0; i < _activeGameObjects; i++) {
+    total += _gameObjects.sprite[i] != VOID_ID;
+  }
+  return total;
+}
@@ -1,9 +1,25 @@
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "graphic.h"
+#include "pack.h"
 #include "widget.h"
+#include "pool.h"
 
 #define MAX_TEXTURES 1024
+#define INITIAL_TEXTURES 64
+#define INITIAL_SPRITES 1024
+#define MAX_TILE_LAYERS 16
+#define INITIAL_TILE_LAYERS 4
+#define TILE_CHUNK_SIZE 16
+#define DEFAULT_CHUNK_BUDGET (64 * 1024 * 1024)
+#define CHUNK_ZOOM_LEVELS 5
+#define MAX_CLIPS 1024
+#define INITIAL_CLIPS 16
+#define INITIAL_ANIMATIONS 256
+#define MAX_DECODERS 4
 
 typedef struct {
     SDL_Texture* texture;
@@ -18,19 +34,185 @@ typedef struct {
 static SDL_Window* _window;
 static SDL_Renderer* _renderer;
 static TTF_Font* _font;
-
+static Graphic_Backend _backend;
+
+/*
+ * The software and null backends have no window: they render into _surface
+ * and report the size given to Graphic_Init as the window size. The null
+ * backend's surface is 1x1, it only exists so textures can be created and
+ * queried; draw calls are counted but never submitted.
+ */
+static SDL_Surface* _surface;
+/* Kept up to date by Graphic_ResizeWindow instead of asking the window. */
+static int _windowWidth, _windowHeight;
+static int _maxTextureWidth, _maxTextureHeight;
+static Graphic_RenderStats _stats;
+
+/* Images found in the pack are uploaded from it instead of being decoded. */
+static Pack _pack;
+
+/*
+ * Textures, sprites, clips and tile layers belong to the scope that was
+ * open when they were created, 0 being outside of any.
+ */
+static int _scope;
+
+/* Textures still being decoded are pending and show a placeholder. */
 static struct {
-    SDL_Texture* textures[MAX_TEXTURES];
-    SET_STRUCT_FOR_DOD(Id, MAX_TEXTURES);
+    SDL_Texture** textures;
+    bool* pending;
+    unsigned char* scope;
+    Pool pool;
 } _textures;
 
+typedef enum {
+  _DecodeQueued,
+  _DecodeRunning,
+  _DecodeDone,
+} _DecodeState;
+
+typedef struct {
+  _DecodeState state;
+  Id texture;
+  char* filename;
+  SDL_Surface* surface;
+} _Decode;
+
+/*
+ * Images loaded with Graphic_LoadTextureAsync are decoded by worker
+ * threads, then turned into textures on the render thread, since only it
+ * may use the renderer. Everything here is guarded by mutex.
+ */
 static struct {
-  _Sprite sprite[MAX_SPRITES];
-  RectF rectF[MAX_SPRITES];
+  SDL_Thread* threads[MAX_DECODERS];
+  int totalThreads;
+  SDL_mutex* mutex;
+  SDL_cond* queued;
+  SDL_cond* done;
+  _Decode* decodes;
+  int totalDecodes, maxDecodes;
+  bool quit;
+} _decoder;
+
+/*
+ * Text sprites own their texture, other sprites use a pooled one. Sprites
+ * showing the whole texture keep doing so once a pending one is uploaded.
+ */
+typedef struct {
+  unsigned char scope;
+  unsigned char layer;
+  bool ownsTexture;
+  bool wholeTexture;
+} _SpriteInfo;
+
+/*
+ * Active sprites come first: [0, totalActive) is what gets rendered, one
+ * layer after the other. Layer l's draw list is [layerStarts[l], the next
+ * layer's start), the last one ending at totalActive. Each sprite knows the
+ * animation playing on it, if any.
+ */
+static struct {
+  _Sprite* sprite;
+  RectF* rectF;
+  Id* animation;
+  _SpriteInfo* info;
+  Index layerStarts[Graphic_TotalLayers];
   unsigned int totalActive;
-  SET_STRUCT_FOR_DOD(Id, MAX_SPRITES);
+  Pool pool;
 } _sprites;
 
+/* Layer the sprites being created go to. */
+static Graphic_Layer _layer;
+
+static Index
+_getLayerEnd(Graphic_Layer layer)
+{
+  if (layer + 1 == Graphic_TotalLayers) {
+    return _sprites.totalActive;
+  }
+  return _sprites.layerStarts[layer + 1];
+}
+
+/* A clip's frames are a run of the shared, packed frames array. */
+typedef struct {
+  int firstFrame, totalFrames;
+  int frameTicks;
+  int scope;
+} _Clip;
+
+static struct {
+  _Clip* clips;
+  SDL_Rect* frames;
+  int totalFrames, maxFrames;
+  Pool pool;
+} _clips;
+
+/*
+ * Only sprites playing a clip have an animation, so sprites that don't
+ * move cost nothing when animations advance.
+ */
+typedef struct {
+  Id sprite;
+  Id clip;
+  int frame;
+  int ticks;
+} _Animation;
+
+static struct {
+  _Animation* animations;
+  Pool pool;
+} _animations;
+
+/* Levels with a texture are linked from the least recently visible. */
+typedef struct _ChunkLevel {
+  SDL_Texture* texture;
+  unsigned long lastVisible;
+  struct _ChunkLevel* older;
+  struct _ChunkLevel* newer;
+  struct _TileChunk* chunk;
+} _ChunkLevel;
+
+/*
+ * Chunk tiles are only allocated once a tile is set in the chunk. Level l
+ * is the chunk baked at zoom l + 1, so integer zooms blit it 1:1; bit l of
+ * bakedLevels tells whether its texture is up to date.
+ */
+typedef struct _TileChunk {
+  SmallId* tiles;
+  SDL_Rect bounds;
+  _ChunkLevel levels[CHUNK_ZOOM_LEVELS];
+  Uint8 bakedLevels;
+  bool measured;
+} _TileChunk;
+
+/*
+ * A tile is drawn no further than reach from its position, which bounds the
+ * tiles the viewport can show.
+ */
+typedef struct {
+  Id textureId;
+  Graphic_TileProjection projection;
+  int width, height;
+  int tileWidth, tileHeight;
+  int chunksWide, chunksHigh;
+  int reach;
+  SDL_Rect* palette;
+  int paletteSize;
+  _TileChunk* chunks;
+  int scope;
+} _TileLayer;
+
+/* Layers are drawn in creation order, so deleting one keeps that order. */
+static struct {
+  _TileLayer* layers;
+  size_t bakedBytes;
+  size_t budget;
+  unsigned long frame;
+  _ChunkLevel* oldest;
+  _ChunkLevel* newest;
+  Pool pool;
+} _tileLayers;
+
 static struct {
   int x, y;
   double zoom;
@@ -40,6 +222,152 @@ static struct {
   } bounds;
 } _camera;
 
+/* What a layer's sprites are placed with. */
+typedef struct {
+  double x, y, zoom;
+} _Transform;
+
+/* Same transform as the zoomed sprites: zooming keeps the screen centered. */
+static SDL_Rect
+_worldToScreen(SDL_Rect rect, int w, int h)
+{
+  SDL_Rect dest;
+  dest.x = (rect.x - _camera.x) * _camera.zoom - w / 2 * (_camera.zoom - 1);
+  dest.y = (rect.y - _camera.y) * _camera.zoom - h / 2 * (_camera.zoom - 1);
+  dest.w = rect.w * _camera.zoom;
+  dest.h = rect.h * _camera.zoom;
+  return dest;
+}
+
+static SDL_Point
+_getTilePosition(const _TileLayer* layer, int x, int y)
+{
+  SDL_Point position;
+  if (layer->projection == Graphic_IsometricTiles) {
+    position.x = (x - y) * (layer->tileWidth / 2);
+    position.y = (x + y) * (layer->tileHeight / 2);
+  } else {
+    position.x = x * layer->tileWidth;
+    position.y = y * layer->tileHeight;
+  }
+  return position;
+}
+
+static size_t
+_getChunkBytes(const _TileChunk* chunk, int level)
+{
+  int scale = level + 1;
+  return (size_t) chunk->bounds.w * scale * chunk->bounds.h * scale * 4;
+}
+
+static void
+_unlinkChunkLevel(_ChunkLevel* level)
+{
+  if (level->older) {
+    level->older->newer = level->newer;
+  } else {
+    _tileLayers.oldest = level->newer;
+  }
+  if (level->newer) {
+    level->newer->older = level->older;
+  } else {
+    _tileLayers.newest = level->older;
+  }
+  level->older = NULL;
+  level->newer = NULL;
+}
+
+static void
+_linkNewestChunkLevel(_ChunkLevel* level)
+{
+  level->older = _tileLayers.newest;
+  level->newer = NULL;
+  if (_tileLayers.newest) {
+    _tileLayers.newest->newer = level;
+  } else {
+    _tileLayers.oldest = level;
+  }
+  _tileLayers.newest = level;
+}
+
+static void
+_evictTileChunk(_TileChunk* chunk, int level)
+{
+  _unlinkChunkLevel(&chunk->levels[level]);
+  SDL_DestroyTexture(chunk->levels[level].texture);
+  _tileLayers.bakedBytes -= _getChunkBytes(chunk, level);
+  chunk->levels[level].texture = NULL;
+  chunk->bakedLevels &= ~(1 << level);
+}
+
+static void
+_evictTileChunkLevels(_TileChunk* chunk)
+{
+  for (int level = 0; level < CHUNK_ZOOM_LEVELS; level++) {
+    if (chunk->levels[level].texture) {
+      _evictTileChunk(chunk, level);
+    }
+  }
+}
+
+static SDL_Rect
+_getTileDest(const _TileLayer* layer, int x, int y, SmallId tile)
+{
+  SDL_Rect src = layer->palette[tile];
+  SDL_Point position = _getTilePosition(layer, x, y);
+  SDL_Rect dest;
+  dest.x = position.x;
+  dest.y = position.y - (src.h - layer->tileHeight);
+  dest.w = src.w;
+  dest.h = src.h;
+  return dest;
+}
+
+static void
+_measureTileChunk(const _TileLayer* layer, _TileChunk* chunk, int cx, int cy)
+{
+  // Runs over every tile of the map when a level loads, so track the edges
+  // directly rather than through SDL_UnionRect.
+  int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+  for (int y = 0; y < TILE_CHUNK_SIZE; y++) {
+    for (int x = 0; x < TILE_CHUNK_SIZE; x++) {
+      SmallId tile = chunk->tiles[y * TILE_CHUNK_SIZE + x];
+      if (tile == VOID_SMALL_ID) {
+        continue;
+      }
+
+      SDL_Rect dest = _getTileDest(
+        layer, 
+        cx * TILE_CHUNK_SIZE + x, 
+        cy * TILE_CHUNK_SIZE + y, 
+        tile
+      );
+      if (dest.w <= 0 || dest.h <= 0) {
+        continue;
+      }
+      left = SDL_min(left, dest.x);
+      top = SDL_min(top, dest.y);
+      right = SDL_max(right, dest.x + dest.w);
+      bottom = SDL_max(bottom, dest.y + dest.h);
+    }
+  }
+
+  SDL_Rect bounds = {0};
+  if (left < right && top < bottom) {
+    bounds.x = left;
+    bounds.y = top;
+    bounds.w = right - left;
+    bounds.h = bottom - top;
+  }
+
+  // Textures of another size can't be rebaked in place.
+  if (bounds.w != chunk->bounds.w || bounds.h != chunk->bounds.h) {
+    _evictTileChunkLevels(chunk);
+  }
+  chunk->bounds = bounds;
+  chunk->measured = true;
+}
+
 static void
 _updateCameraBoundLeft(int x)
 {
@@ -86,7 +414,9 @@ _updateCameraBounds()
     _camera.bounds.h = INT_MAX;
     _camera.bounds.dirty = false;
 
-    for (Index i = 0; i < _sprites.totalActive; i++) {
+    // The world's extent is where the camera may go.
+    Index end = _getLayerEnd(Graphic_WorldLayer);
+    for (Index i = 0; i < end; i++) {
       _updateCameraBoundLeft(_sprites.sprite[i].dest.x);
       _updateCameraBoundRight(
         _sprites.sprite[i].dest.x,
@@ -98,31 +428,102 @@ _updateCameraBounds()
         _sprites.sprite[i].dest.h      
       );
     }
+
+    int w, h;
+    Graphic_QueryWindowSize(&w, &h);
+    for (Index i = 0; i < _tileLayers.pool.total; i++) {
+      _TileLayer* layer = &_tileLayers.layers[i];
+      for (int cy = 0; cy < layer->chunksHigh; cy++) {
+        for (int cx = 0; cx < layer->chunksWide; cx++) {
+          _TileChunk* chunk = &layer->chunks[cy * layer->chunksWide + cx];
+          if (!chunk->tiles) {
+            continue;
+          }
+          if (!chunk->measured) {
+            _measureTileChunk(layer, chunk, cx, cy);
+          }
+
+          SDL_Rect dest = _worldToScreen(chunk->bounds, w, h);
+          _updateCameraBoundLeft(dest.x);
+          _updateCameraBoundRight(dest.x, dest.w);
+          _updateCameraBoundTop(dest.y);
+          _updateCameraBoundBottom(dest.y, dest.h);
+        }
+      }
+    }
   }
 }
 
+/* Screen sprites are placed in window coordinates, the others in the world. */
+static _Transform
+_getTransform(Graphic_Layer layer)
+{
+  _Transform transform = { _camera.x, _camera.y, _camera.zoom };
+  if (layer == Graphic_ScreenLayer) {
+    transform.x = 0;
+    transform.y = 0;
+    transform.zoom = 1.0;
+  }
+  return transform;
+}
+
 static SDL_Rect 
-_applyCameraToDest(SDL_Rect dest)
+_applyCameraToDest(Graphic_Layer layer, SDL_Rect dest)
 {
-  dest.x -= _camera.x;
-  dest.y -= _camera.y;
-  dest.x *= _camera.zoom;
-  dest.y *= _camera.zoom;
-  dest.w *= _camera.zoom;
-  dest.h *= _camera.zoom;
+  if (layer == Graphic_ScreenLayer) {
+    return dest;
+  }
 
-  return dest;
+  // Sprites created while zoomed in must land where zooming moved the others.
+  int w, h;
+  Graphic_QueryWindowSize(&w, &h);
+  return _worldToScreen(dest, w, h);
 }
 
-static void
-_swap(Index it, Id id, Index with)
+/* Appends an inactive sprite to its layer's draw list, returns its index. */
+static Index
+_activateSprite(Index index)
 {
-    _sprites.sprite[it] = _sprites.sprite[with];
-    _sprites.rectF[it] = _sprites.rectF[with];
-    _sprites.indexes[_sprites.ids[with]] = it;
-    _sprites.indexes[_sprites.ids[it]] = with;
-    _sprites.ids[it] = _sprites.ids[with];
-    _sprites.ids[with] = id;
+  assert(index >= _sprites.totalActive);
+  Graphic_Layer layer = _sprites.info[index].layer;
+  Index end = _getLayerEnd(layer);
+  Pool_Swap(&_sprites.pool, index, _sprites.totalActive);
+  // Only the layers drawn above it shift.
+  Pool_Move(&_sprites.pool, _sprites.totalActive, end);
+  _sprites.totalActive++;
+  for (int l = layer + 1; l < Graphic_TotalLayers; l++) {
+    _sprites.layerStarts[l]++;
+  }
+  _camera.bounds.dirty = true;
+  return end;
+}
+
+/*
+ * Takes an active sprite out of the draw lists, returns its index. Like
+ * before layers, the last sprite of its layer takes its place.
+ */
+static Index
+_deactivateSprite(Index index)
+{
+  assert(index < _sprites.totalActive);
+  Graphic_Layer layer = _sprites.info[index].layer;
+  Index last = _getLayerEnd(layer) - 1;
+  Pool_Swap(&_sprites.pool, index, last);
+  Pool_Move(&_sprites.pool, last, --_sprites.totalActive);
+  for (int l = layer + 1; l < Graphic_TotalLayers; l++) {
+    _sprites.layerStarts[l]--;
+  }
+  _camera.bounds.dirty = true;
+  return _sprites.totalActive;
+}
+
+static inline bool
+_isInViewport(const SDL_Rect* dest, const SDL_Rect* viewport)
+{
+  return dest->x < viewport->x + viewport->w && 
+         dest->x + dest->w > viewport->x &&
+         dest->y < viewport->y + viewport->h && 
+         dest->y + dest->h > viewport->y;
 }
 
 static RectF
@@ -136,22 +537,33 @@ _convertRectToRectF(SDL_Rect rect)
   return rectF;
 }
 
+static Id
+_createTexture(SDL_Texture* texture, bool pending)
+{
+  Index index;
+  Id id = Pool_Create(&_textures.pool, &index);
+  _textures.textures[index] = texture;
+  _textures.pending[index] = pending;
+  _textures.scope[index] = _scope;
+  return id;
+}
+
 static Id 
 _createTilesetSprite(SDL_Texture* texture, SDL_Rect src, SDL_Rect dest) 
 {
   Index index;
-  Id id;
-  GET_NEXT_ID(_sprites, id, index, MAX_SPRITES);
+  Id id = Pool_Create(&_sprites.pool, &index);
+  _sprites.animation[index] = VOID_ID;
+  _sprites.info[index].scope = _scope;
+  _sprites.info[index].layer = _layer;
+  _sprites.info[index].ownsTexture = false;
+  _sprites.info[index].wholeTexture = false;
+  index = _activateSprite(index);
 
-  if (_sprites.totalActive < index) {
-    _swap(index, id, _sprites.totalActive);
-  }
-
-  _sprites.sprite[_sprites.totalActive].src = src;
-  _sprites.rectF[_sprites.totalActive] = _convertRectToRectF(dest);
-  _sprites.sprite[_sprites.totalActive].dest = _applyCameraToDest(dest);
-  _sprites.sprite[_sprites.totalActive].texture = texture;
-  _sprites.totalActive++;
+  _sprites.sprite[index].src = src;
+  _sprites.rectF[index] = _convertRectToRectF(dest);
+  _sprites.sprite[index].dest = _applyCameraToDest(_layer, dest);
+  _sprites.sprite[index].texture = texture;
 
   return id;
 }
@@ -190,10 +602,83 @@ Graphic_CreateTextSDLTexture(
   return texture;
 }
 
+static bool
+_createHardwareRenderer(const char * const title, int w, int h)
+{
+  _window = SDL_CreateWindow(
+    title,
+    SDL_WINDOWPOS_CENTERED,
+    SDL_WINDOWPOS_CENTERED,
+    w,
+    h,
+    SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+  );
+
+  if (_window == NULL) {
+    fprintf(stderr, "Window couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    return false;
+  }
+
+  _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED);
+
+  if (_renderer == NULL) {
+    fprintf(
+      stderr, 
+      "Accelerated renderer could not be created, falling back to software! "
+      "SDL_Error: %s\n", 
+      SDL_GetError()
+    );
+    _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_SOFTWARE);
+  }
+
+  if (_renderer == NULL) {
+    fprintf(stderr, "Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+    return false;
+  }
+
+  SDL_GetWindowSize(_window, &_windowWidth, &_windowHeight);
+  return true;
+}
+
+static bool
+_createSurfaceRenderer(int w, int h, int surfaceW, int surfaceH)
+{
+  _surface = SDL_CreateRGBSurfaceWithFormat(
+    0,
+    surfaceW,
+    surfaceH,
+    32,
+    SDL_PIXELFORMAT_ARGB8888
+  );
+
+  if (_surface == NULL) {
+    fprintf(stderr, "Surface couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    return false;
+  }
+
+  _renderer = SDL_CreateSoftwareRenderer(_surface);
+
+  if (_renderer == NULL) {
+    fprintf(stderr, "Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+    return false;
+  }
+
+  _windowWidth = w;
+  _windowHeight = h;
+  return true;
+}
+
 bool 
-Graphic_Init(const char * const title, int w, int h, int font_size) 
+Graphic_Init(
+  const char * const title, 
+  int w, 
+  int h, 
+  int font_size,
+  Graphic_Backend backend) 
 {
-  if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+  _backend = backend;
+
+  if (backend == Graphic_HardwareBackend && SDL_Init(SDL_INIT_VIDEO) != 0) {
     fprintf(stderr, "SDL couldn't initialize! SDL_Error: %s\n", SDL_GetError());
     return false;
   }
@@ -214,76 +699,761 @@ Graphic_Init(const char * const title, int w, int h, int font_size)
     return false;
   }
 
-  _window = SDL_CreateWindow(
-    title,
-    SDL_WINDOWPOS_CENTERED,
-    SDL_WINDOWPOS_CENTERED,
-    w,
-    h,
-    SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
-  );
+  switch (backend) {
+    case Graphic_HardwareBackend:
+      if (!_createHardwareRenderer(title, w, h)) {
+        return false;
+      }
+      break;
+    case Graphic_SoftwareBackend:
+      if (!_createSurfaceRenderer(w, h, w, h)) {
+        return false;
+      }
+      break;
+    case Graphic_NullBackend:
+      if (!_createSurfaceRenderer(w, h, 1, 1)) {
+        return false;
+      }
+      break;
+  }
 
-  if (_window == NULL) {
-    fprintf(stderr, "Window couldn't be created! SDL_Error: %s\n", SDL_GetError());
-    return false;
+  SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
+
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(_renderer, &info) == 0) {
+    _maxTextureWidth = info.max_texture_width;
+    _maxTextureHeight = info.max_texture_height;
   }
 
+  Pool_Init(&_sprites.pool, INITIAL_SPRITES, MAX_SPRITES);
+  POOL_ADD_COLUMN(&_sprites.pool, _sprites.sprite);
+  POOL_ADD_COLUMN(&_sprites.pool, _sprites.rectF);
+  POOL_ADD_COLUMN(&_sprites.pool, _sprites.animation);
+  POOL_ADD_COLUMN(&_sprites.pool, _sprites.info);
+  Pool_Init(&_clips.pool, INITIAL_CLIPS, MAX_CLIPS);
+  POOL_ADD_COLUMN(&_clips.pool, _clips.clips);
+  Pool_Init(&_animations.pool, INITIAL_ANIMATIONS, MAX_SPRITES);
+  POOL_ADD_COLUMN(&_animations.pool, _animations.animations);
+  Pool_Init(&_textures.pool, INITIAL_TEXTURES, MAX_TEXTURES);
+  POOL_ADD_COLUMN(&_textures.pool, _textures.textures);
+  POOL_ADD_COLUMN(&_textures.pool, _textures.pending);
+  POOL_ADD_COLUMN(&_textures.pool, _textures.scope);
+  Pool_Init(&_tileLayers.pool, INITIAL_TILE_LAYERS, MAX_TILE_LAYERS);
+  POOL_ADD_COLUMN(&_tileLayers.pool, _tileLayers.layers);
+  _tileLayers.budget = DEFAULT_CHUNK_BUDGET;
 
-  _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED);
+  return true;
+}
 
-  if (_renderer == NULL) {
-    fprintf(stderr, "Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
-    return false;
+/*
+ * Frees baked chunk levels, least recently visible first, until bytes more
+ * fit in the budget. Levels visible this frame are kept even if that means
+ * going over budget.
+ */
+static void
+_evictTileChunks(size_t bytes)
+{
+  while (_tileLayers.bakedBytes + bytes > _tileLayers.budget) {
+    // Visible levels are moved to the newest end, so the rest are too.
+    _ChunkLevel* oldest = _tileLayers.oldest;
+    if (!oldest || oldest->lastVisible == _tileLayers.frame) {
+      return;
+    }
+    _evictTileChunk(oldest->chunk, oldest - oldest->chunk->levels);
   }
+}
 
-  SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
+/*
+ * The level closest to the camera zoom whose texture the renderer can hold.
+ * Zooming out below 1 samples down level 0.
+ */
+static int
+_getChunkLevel(const _TileChunk* chunk)
+{
+  int level = (int) (_camera.zoom + 0.5) - 1;
+  if (level < 0) {
+    level = 0;
+  } else if (level >= CHUNK_ZOOM_LEVELS) {
+    level = CHUNK_ZOOM_LEVELS - 1;
+  }
 
+  while (level > 0 && 
+         ((_maxTextureWidth && chunk->bounds.w * (level + 1) > _maxTextureWidth) ||
+          (_maxTextureHeight && chunk->bounds.h * (level + 1) > _maxTextureHeight))) {
+    level--;
+  }
+  return level;
+}
 
-  SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_BLEND);
+static void
+_bakeTileChunk(
+  const _TileLayer* layer, 
+  _TileChunk* chunk, 
+  int cx, 
+  int cy, 
+  int level)
+{
+  _stats.bakes++;
+  chunk->bakedLevels |= 1 << level;
+  if (_backend == Graphic_NullBackend) {
+    return;
+  }
+
+  int scale = level + 1;
+  _ChunkLevel* baked = &chunk->levels[level];
+  if (!baked->texture) {
+    _evictTileChunks(_getChunkBytes(chunk, level));
+    // The window's format may have no alpha to keep the corners clear.
+    baked->texture = SDL_CreateTexture(
+      _renderer,
+      SDL_PIXELFORMAT_ARGB8888,
+      SDL_TEXTUREACCESS_TARGET,
+      chunk->bounds.w * scale,
+      chunk->bounds.h * scale
+    );
+    if (baked->texture == NULL) {
+      fprintf(stderr, "Chunk texture couldn't be created! SDL_Error: %s\n", SDL_GetError());
+      exit(EXIT_FAILURE);
+    }
+    // Chunk boxes overlap on isometric layers, their corners must blend.
+    SDL_SetTextureBlendMode(baked->texture, SDL_BLENDMODE_BLEND);
+    _tileLayers.bakedBytes += _getChunkBytes(chunk, level);
+    baked->chunk = chunk;
+    _linkNewestChunkLevel(baked);
+  }
 
-  INIT_STRUCT_FOR_DOD_FREE_LIST(_sprites, MAX_SPRITES);
-  INIT_STRUCT_FOR_DOD_FREE_LIST(_textures, MAX_TEXTURES);
+  Index textureIdx = Pool_GetIndex(&_textures.pool, layer->textureId);
+  SDL_Texture* tileset = _textures.textures[textureIdx];
 
+  SDL_Texture* target = SDL_GetRenderTarget(_renderer);
+  SDL_SetRenderTarget(_renderer, baked->texture);
+  SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0x00);
+  SDL_RenderClear(_renderer);
+  for (int y = 0; y < TILE_CHUNK_SIZE; y++) {
+    for (int x = 0; x < TILE_CHUNK_SIZE; x++) {
+      SmallId tile = chunk->tiles[y * TILE_CHUNK_SIZE + x];
+      if (tile == VOID_SMALL_ID) {
+        continue;
+      }
+
+      SDL_Rect dest = _getTileDest(
+        layer, 
+        cx * TILE_CHUNK_SIZE + x, 
+        cy * TILE_CHUNK_SIZE + y, 
+        tile
+      );
+      dest.x = (dest.x - chunk->bounds.x) * scale;
+      dest.y = (dest.y - chunk->bounds.y) * scale;
+      dest.w *= scale;
+      dest.h *= scale;
+      SDL_RenderCopy(_renderer, tileset, &layer->palette[tile], &dest);
+    }
+  }
+  SDL_SetRenderTarget(_renderer, target);
+}
+
+/* Clamps the tiles from first to last to the layer, false if none are in. */
+static bool
+_clampTileRange(double first, double last, int size, int* from, int* to)
+{
+  if (last < 0 || first >= size) {
+    return false;
+  }
+  *from = first < 0 ? 0 : (int) first;
+  *to = last >= size ? size - 1 : (int) last;
   return true;
 }
 
+/*
+ * The chunks whose tiles may show in the viewport, from the tile positions
+ * its corners map back to. Isometric ranges cover the box around the view's
+ * diamond, so some of their chunks are still culled.
+ */
+static bool
+_queryVisibleChunks(const _TileLayer* layer, const SDL_Rect* viewport, SDL_Rect* chunks)
+{
+  // The inverse of _worldToScreen, widened by how far tiles are drawn.
+  double shiftX = viewport->w / 2 * (_camera.zoom - 1);
+  double shiftY = viewport->h / 2 * (_camera.zoom - 1);
+  double left = (viewport->x + shiftX) / _camera.zoom + _camera.x - layer->reach;
+  double top = (viewport->y + shiftY) / _camera.zoom + _camera.y - layer->reach;
+  double right = (viewport->x + viewport->w + shiftX) / _camera.zoom + _camera.x + layer->reach;
+  double bottom = (viewport->y + viewport->h + shiftY) / _camera.zoom + _camera.y + layer->reach;
+
+  double firstX, lastX, firstY, lastY;
+  if (layer->projection == Graphic_IsometricTiles) {
+    // x - y and x + y grow along the screen's axes.
+    double halfWidth = layer->tileWidth / 2, halfHeight = layer->tileHeight / 2;
+    firstX = floor((left / halfWidth + top / halfHeight) / 2);
+    lastX = ceil((right / halfWidth + bottom / halfHeight) / 2);
+    firstY = floor((top / halfHeight - right / halfWidth) / 2);
+    lastY = ceil((bottom / halfHeight - left / halfWidth) / 2);
+  } else {
+    firstX = floor(left / layer->tileWidth);
+    lastX = ceil(right / layer->tileWidth);
+    firstY = floor(top / layer->tileHeight);
+    lastY = ceil(bottom / layer->tileHeight);
+  }
+
+  int x0, x1, y0, y1;
+  if (!_clampTileRange(firstX, lastX, layer->width, &x0, &x1) ||
+      !_clampTileRange(firstY, lastY, layer->height, &y0, &y1)) {
+    return false;
+  }
+  chunks->x = x0 / TILE_CHUNK_SIZE;
+  chunks->y = y0 / TILE_CHUNK_SIZE;
+  chunks->w = x1 / TILE_CHUNK_SIZE - chunks->x + 1;
+  chunks->h = y1 / TILE_CHUNK_SIZE - chunks->y + 1;
+  return true;
+}
+
+static void
+_renderTileLayers(const SDL_Rect* viewport)
+{
+  for (Index i = 0; i < _tileLayers.pool.total; i++) {
+    _TileLayer* layer = &_tileLayers.layers[i];
+    SDL_Rect chunks;
+    // Chunks baked from the placeholder would have to be baked again.
+    if (!Graphic_IsTextureLoaded(layer->textureId) ||
+        !_queryVisibleChunks(layer, viewport, &chunks)) {
+      continue;
+    }
+    for (int cy = chunks.y; cy < chunks.y + chunks.h; cy++) {
+      for (int cx = chunks.x; cx < chunks.x + chunks.w; cx++) {
+        _TileChunk* chunk = &layer->chunks[cy * layer->chunksWide + cx];
+        if (!chunk->tiles) {
+          continue;
+        }
+        if (!chunk->measured) {
+          _measureTileChunk(layer, chunk, cx, cy);
+        }
+        if (chunk->bounds.w == 0) {
+          continue;
+        }
+
+        SDL_Rect dest = _worldToScreen(chunk->bounds, viewport->w, viewport->h);
+        if (!_isInViewport(&dest, viewport)) {
+          _stats.culled++;
+          continue;
+        }
+
+        int level = _getChunkLevel(chunk);
+        _ChunkLevel* visible = &chunk->levels[level];
+        visible->lastVisible = _tileLayers.frame;
+        if (visible->texture && visible != _tileLayers.newest) {
+          _unlinkChunkLevel(visible);
+          _linkNewestChunkLevel(visible);
+        }
+        if (!(chunk->bakedLevels & (1 << level))) {
+          _bakeTileChunk(layer, chunk, cx, cy, level);
+        }
+        Graphic_RenderCopy(visible->texture, NULL, &dest);
+        _stats.chunks++;
+      }
+    }
+  }
+  _tileLayers.frame++;
+}
+
+static void
+_freeTileLayer(_TileLayer* layer)
+{
+  int total = layer->chunksWide * layer->chunksHigh;
+  for (int c = 0; c < total; c++) {
+    _evictTileChunkLevels(&layer->chunks[c]);
+    free(layer->chunks[c].tiles);
+  }
+  free(layer->chunks);
+  free(layer->palette);
+}
+
+static void
+_clearTileLayers()
+{
+  for (Index i = 0; i < _tileLayers.pool.total; i++) {
+    _freeTileLayer(&_tileLayers.layers[i]);
+  }
+  Pool_Clear(&_tileLayers.pool);
+  _camera.bounds.dirty = true;
+}
+
+/* Doesn't touch the renderer, so it is safe on any thread. */
+static SDL_Surface*
+_decodeImage(const char* filename)
+{
+  SDL_Surface* surface = IMG_Load(filename);
+  if (surface) {
+    Uint32 colorkey = SDL_MapRGB(surface->format, 0xff, 0, 0xff);
+    SDL_SetColorKey(surface, SDL_TRUE, colorkey);
+  }
+  return surface;
+}
+
+static int
+_decodeImages(void* data)
+{
+  (void) data;
+  SDL_LockMutex(_decoder.mutex);
+  while (!_decoder.quit) {
+    char* filename = NULL;
+    for (int i = 0; i < _decoder.totalDecodes && !filename; i++) {
+      if (_decoder.decodes[i].state == _DecodeQueued) {
+        _decoder.decodes[i].state = _DecodeRunning;
+        filename = _decoder.decodes[i].filename;
+      }
+    }
+    if (filename == NULL) {
+      SDL_CondWait(_decoder.queued, _decoder.mutex);
+      continue;
+    }
+
+    SDL_UnlockMutex(_decoder.mutex);
+    SDL_Surface* surface = _decodeImage(filename);
+    SDL_LockMutex(_decoder.mutex);
+
+    // Other decodes may have moved meanwhile, but not this one's filename.
+    for (int i = 0; i < _decoder.totalDecodes; i++) {
+      if (_decoder.decodes[i].filename == filename) {
+        _decoder.decodes[i].surface = surface;
+        _decoder.decodes[i].state = _DecodeDone;
+      }
+    }
+    SDL_CondBroadcast(_decoder.done);
+  }
+  SDL_UnlockMutex(_decoder.mutex);
+  return 0;
+}
+
+static void
+_startDecoders()
+{
+  if (_decoder.mutex) {
+    return;
+  }
+
+  _decoder.mutex = SDL_CreateMutex();
+  _decoder.queued = SDL_CreateCond();
+  _decoder.done = SDL_CreateCond();
+  if (!_decoder.mutex || !_decoder.queued || !_decoder.done) {
+    fprintf(stderr, "Decoder couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    exit(EXIT_FAILURE);
+  }
+
+  // Leave a core to the render thread.
+  int total = SDL_max(1, SDL_min(SDL_GetCPUCount() - 1, MAX_DECODERS));
+  for (int i = 0; i < total; i++) {
+    SDL_Thread* thread = SDL_CreateThread(_decodeImages, "decoder", NULL);
+    if (thread == NULL) {
+      fprintf(stderr, "Decoder thread could not start! SDL_Error: %s\n", SDL_GetError());
+      break;
+    }
+    _decoder.threads[_decoder.totalThreads++] = thread;
+  }
+}
+
+static void
+_stopDecoders()
+{
+  if (_decoder.mutex == NULL) {
+    return;
+  }
+
+  SDL_LockMutex(_decoder.mutex);
+  _decoder.quit = true;
+  SDL_CondBroadcast(_decoder.queued);
+  SDL_UnlockMutex(_decoder.mutex);
+  for (int i = 0; i < _decoder.totalThreads; i++) {
+    SDL_WaitThread(_decoder.threads[i], NULL);
+  }
+
+  for (int i = 0; i < _decoder.totalDecodes; i++) {
+    SDL_FreeSurface(_decoder.decodes[i].surface);
+    free(_decoder.decodes[i].filename);
+  }
+  free(_decoder.decodes);
+  SDL_DestroyCond(_decoder.done);
+  SDL_DestroyCond(_decoder.queued);
+  SDL_DestroyMutex(_decoder.mutex);
+  memset(&_decoder, 0, sizeof(_decoder));
+}
+
+/* Must be called with the decoder's mutex held. */
+static int
+_findDecode(Id texture)
+{
+  for (int i = 0; i < _decoder.totalDecodes; i++) {
+    if (_decoder.decodes[i].texture == texture) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Must be called with the decoder's mutex held. */
+static _Decode
+_removeDecode(int i)
+{
+  _Decode decode = _decoder.decodes[i];
+  _decoder.decodes[i] = _decoder.decodes[--_decoder.totalDecodes];
+  return decode;
+}
+
+/*
+ * Drops the decodes of texture, or of every texture if all. Decodes a
+ * worker is running are left for _uploadDecodedTextures to free.
+ */
+static void
+_cancelDecodes(Id texture, bool all)
+{
+  if (_decoder.mutex == NULL) {
+    return;
+  }
+
+  SDL_LockMutex(_decoder.mutex);
+  for (int i = 0; i < _decoder.totalDecodes; ) {
+    _Decode* decode = &_decoder.decodes[i];
+    if (!all && decode->texture != texture) {
+      i++;
+    } else if (decode->state == _DecodeQueued) {
+      free(_removeDecode(i).filename);
+    } else {
+      decode->texture = VOID_ID;
+      i++;
+    }
+  }
+  SDL_UnlockMutex(_decoder.mutex);
+}
+
+static void
+_uploadDecode(_Decode* decode)
+{
+  if (decode->texture != VOID_ID) {
+    SDL_Texture* texture = NULL;
+    if (decode->surface) {
+      texture = SDL_CreateTextureFromSurface(_renderer, decode->surface);
+    }
+    if (texture == NULL) {
+      fprintf(
+        stderr, "Texture %s could not be loaded! SDL_Error: %s\n", 
+        decode->filename, 
+        SDL_GetError()
+      );
+      exit(EXIT_FAILURE);
+    }
+
+    Index index = Pool_GetIndex(&_textures.pool, decode->texture);
+    SDL_Texture* placeholder = _textures.textures[index];
+    SDL_Rect whole = { 0, 0, 0, 0 };
+    SDL_QueryTexture(texture, NULL, NULL, &whole.w, &whole.h);
+
+    for (Index i = 0; i < _sprites.pool.total; i++) {
+      _Sprite* sprite = &_sprites.sprite[i];
+      if (sprite->texture != placeholder) {
+        continue;
+      }
+      sprite->texture = texture;
+      if (_sprites.info[i].wholeTexture) {
+        sprite->src = whole;
+      }
+    }
+
+    _textures.textures[index] = texture;
+    _textures.pending[index] = false;
+    SDL_DestroyTexture(placeholder);
+  }
+
+  SDL_FreeSurface(decode->surface);
+  free(decode->filename);
+}
+
+static void
+_uploadDecodedTextures()
+{
+  if (_decoder.mutex == NULL) {
+    return;
+  }
+
+  SDL_LockMutex(_decoder.mutex);
+  for (int i = 0; i < _decoder.totalDecodes; ) {
+    if (_decoder.decodes[i].state != _DecodeDone) {
+      i++;
+      continue;
+    }
+
+    _Decode decode = _removeDecode(i);
+    SDL_UnlockMutex(_decoder.mutex);
+    _uploadDecode(&decode);
+    SDL_LockMutex(_decoder.mutex);
+  }
+  SDL_UnlockMutex(_decoder.mutex);
+}
+
+static SDL_Texture*
+_createPlaceholder()
+{
+  SDL_Texture* texture = SDL_CreateTexture(
+    _renderer, 
+    SDL_PIXELFORMAT_ARGB8888, 
+    SDL_TEXTUREACCESS_STATIC, 
+    1, 
+    1
+  );
+  if (texture == NULL) {
+    fprintf(stderr, "Placeholder couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    exit(EXIT_FAILURE);
+  }
+
+  Uint32 transparent = 0;
+  SDL_UpdateTexture(texture, NULL, &transparent, sizeof(transparent));
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  return texture;
+}
+
 void 
 Graphic_Render() 
 {
-  SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0xFF);
-  SDL_RenderClear(_renderer);
+  if (_backend != Graphic_NullBackend) {
+    SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderClear(_renderer);
+  }
+
+  _uploadDecodedTextures();
+
+  SDL_Rect viewport = {0};
+  Graphic_QueryWindowSize(&viewport.w, &viewport.h);
+
+  _renderTileLayers(&viewport);
 
   for (unsigned int i = 0; i < _sprites.totalActive; i++) {
-    SDL_RenderCopy(
-      _renderer,
+    if (!_isInViewport(&_sprites.sprite[i].dest, &viewport)) {
+      _stats.culled++;
+      continue;
+    }
+
+    Graphic_RenderCopy(
       _sprites.sprite[i].texture,
       &_sprites.sprite[i].src,
       &_sprites.sprite[i].dest
     );
+    _stats.sprites++;
   }
 
   Widget_Render();
-  SDL_RenderPresent(_renderer);
+
+  if (_backend != Graphic_NullBackend) {
+    SDL_RenderPresent(_renderer);
+  }
+  _stats.frames++;
+}
+
+Id
+Graphic_CreateClip(const SDL_Rect* frames, int totalFrames, int frameTicks)
+{
+  assert(totalFrames > 0 && frameTicks > 0);
+
+  if (_clips.totalFrames + totalFrames > _clips.maxFrames) {
+    int maxFrames = SDL_max(2 * _clips.maxFrames, _clips.totalFrames + totalFrames);
+    SDL_Rect* grown = realloc(_clips.frames, maxFrames * sizeof(*grown));
+    if (grown == NULL) {
+      fprintf(stderr, "Clip frames couldn't be allocated!\n");
+      exit(EXIT_FAILURE);
+    }
+    _clips.frames = grown;
+    _clips.maxFrames = maxFrames;
+  }
+
+  Index index;
+  Id id = Pool_Create(&_clips.pool, &index);
+  _clips.clips[index].firstFrame = _clips.totalFrames;
+  _clips.clips[index].totalFrames = totalFrames;
+  _clips.clips[index].frameTicks = frameTicks;
+  _clips.clips[index].scope = _scope;
+  memcpy(_clips.frames + _clips.totalFrames, frames, totalFrames * sizeof(*frames));
+  _clips.totalFrames += totalFrames;
+  return id;
+}
+
+void
+Graphic_PlayClip(Id sprite, Id clip)
+{
+  Index spriteIndex = Pool_GetIndex(&_sprites.pool, sprite);
+  Id animation = _sprites.animation[spriteIndex];
+  Index index;
+  if (animation == VOID_ID) {
+    animation = Pool_Create(&_animations.pool, &index);
+    _sprites.animation[spriteIndex] = animation;
+    _animations.animations[index].sprite = sprite;
+  } else {
+    index = Pool_GetIndex(&_animations.pool, animation);
+    if (_animations.animations[index].clip == clip) {
+      return;
+    }
+  }
+
+  _animations.animations[index].clip = clip;
+  _animations.animations[index].frame = 0;
+  _animations.animations[index].ticks = 0;
+  const _Clip* data = &_clips.clips[Pool_GetIndex(&_clips.pool, clip)];
+  _sprites.sprite[spriteIndex].src = _clips.frames[data->firstFrame];
+  _sprites.info[spriteIndex].wholeTexture = false;
+}
+
+void
+Graphic_StopClip(Id sprite)
+{
+  Index spriteIndex = Pool_GetIndex(&_sprites.pool, sprite);
+  Id animation = _sprites.animation[spriteIndex];
+  if (animation != VOID_ID) {
+    Pool_Delete(&_animations.pool, animation);
+    _sprites.animation[spriteIndex] = VOID_ID;
+  }
+}
+
+void
+Graphic_DeleteClip(Id clip)
+{
+  _Clip deleted = _clips.clips[Pool_GetIndex(&_clips.pool, clip)];
+  Pool_Delete(&_clips.pool, clip);
+
+  // The runs after the clip's move down over it, so frames stay packed.
+  int end = deleted.firstFrame + deleted.totalFrames;
+  memmove(
+    _clips.frames + deleted.firstFrame,
+    _clips.frames + end,
+    (_clips.totalFrames - end) * sizeof(*_clips.frames)
+  );
+  _clips.totalFrames -= deleted.totalFrames;
+  for (Index i = 0; i < _clips.pool.total; i++) {
+    if (_clips.clips[i].firstFrame > deleted.firstFrame) {
+      _clips.clips[i].firstFrame -= deleted.totalFrames;
+    }
+  }
+}
+
+void
+Graphic_AnimateSprites()
+{
+  for (Index i = 0; i < _animations.pool.total; i++) {
+    _Animation* animation = &_animations.animations[i];
+    const _Clip* clip = &_clips.clips[Pool_GetIndex(&_clips.pool, animation->clip)];
+    if (++animation->ticks < clip->frameTicks) {
+      continue;
+    }
+
+    animation->ticks = 0;
+    if (++animation->frame == clip->totalFrames) {
+      animation->frame = 0;
+    }
+    Index sprite = Pool_GetIndex(&_sprites.pool, animation->sprite);
+    _sprites.sprite[sprite].src = _clips.frames[clip->firstFrame + animation->frame];
+  }
+}
+
+void
+Graphic_QueryRenderStats(Graphic_RenderStats* stats)
+{
+  *stats = _stats;
+}
+
+void
+Graphic_ResetRenderStats()
+{
+  _stats.frames = 0;
+  _stats.sprites = 0;
+  _stats.chunks = 0;
+  _stats.bakes = 0;
+  _stats.culled = 0;
+  _stats.drawCalls = 0;
+}
+
+void
+Graphic_QueryResources(Graphic_ResourceStats* stats)
+{
+  stats->textures = _textures.pool.total;
+  stats->sprites = _sprites.pool.total;
+  stats->clips = _clips.pool.total;
+  stats->tileLayers = _tileLayers.pool.total;
 }
 
 Id 
 Graphic_LoadTexture(const char* const filename) 
 {
-  SDL_Texture* texture = Graphic_CreateSDLTexture(filename);
-  Index index;
-  Id id;
-  GET_NEXT_ID(_textures, id, index, MAX_TEXTURES);
-  _textures.textures[index] = texture;
+  return _createTexture(Graphic_CreateSDLTexture(filename), false);
+}
+
+Id
+Graphic_LoadTextureAsync(const char* const filename)
+{
+  // Uploading from the pack is already as fast as it gets.
+  if (Pack_Find(&_pack, filename)) {
+    return Graphic_LoadTexture(filename);
+  }
+
+  _startDecoders();
+
+  Id id = _createTexture(_createPlaceholder(), true);
+
+  size_t length = strlen(filename) + 1;
+  _Decode decode = { _DecodeQueued, id, malloc(length), NULL };
+  if (decode.filename == NULL) {
+    fprintf(stderr, "Decode of %s couldn't be allocated!\n", filename);
+    exit(EXIT_FAILURE);
+  }
+  memcpy(decode.filename, filename, length);
+
+  // Without any worker, decode right away and upload with the others.
+  if (_decoder.totalThreads == 0) {
+    decode.surface = _decodeImage(filename);
+    decode.state = _DecodeDone;
+  }
+
+  SDL_LockMutex(_decoder.mutex);
+  if (_decoder.totalDecodes == _decoder.maxDecodes) {
+    int maxDecodes = _decoder.maxDecodes ? 2 * _decoder.maxDecodes : 8;
+    _Decode* grown = realloc(_decoder.decodes, maxDecodes * sizeof(*grown));
+    if (grown == NULL) {
+      fprintf(stderr, "Decodes couldn't be allocated!\n");
+      exit(EXIT_FAILURE);
+    }
+    _decoder.decodes = grown;
+    _decoder.maxDecodes = maxDecodes;
+  }
+  _decoder.decodes[_decoder.totalDecodes++] = decode;
+  SDL_CondSignal(_decoder.queued);
+  SDL_UnlockMutex(_decoder.mutex);
 
   return id;
 }
 
+bool
+Graphic_IsTextureLoaded(Id id)
+{
+  return !_textures.pending[Pool_GetIndex(&_textures.pool, id)];
+}
+
+void
+Graphic_WaitTexture(Id id)
+{
+  if (Graphic_IsTextureLoaded(id)) {
+    return;
+  }
+
+  SDL_LockMutex(_decoder.mutex);
+  int i = _findDecode(id);
+  while (_decoder.decodes[i].state != _DecodeDone) {
+    SDL_CondWait(_decoder.done, _decoder.mutex);
+    i = _findDecode(id);
+  }
+  _Decode decode = _removeDecode(i);
+  SDL_UnlockMutex(_decoder.mutex);
+
+  _uploadDecode(&decode);
+}
 
 Id 
 Graphic_CreateTilesetSprite(Id texture_id, SDL_Rect src, SDL_Rect dest) 
 {
-  Index texture_index;
-  GET_INDEX_FROM_ID(_textures, texture_id, texture_index);
+  Index texture_index = Pool_GetIndex(&_textures.pool, texture_id);
 
   _camera.bounds.dirty = true;
   return _createTilesetSprite(_textures.textures[texture_index], src, dest);
@@ -292,8 +1462,7 @@ Graphic_CreateTilesetSprite(Id texture_id, SDL_Rect src, SDL_Rect dest)
 Id 
 Graphic_CreateFullTextureSprite(Id texture_id, SDL_Rect dest) 
 {
-  Index texture_index;
-  GET_INDEX_FROM_ID(_textures, texture_id, texture_index);
+  Index texture_index = Pool_GetIndex(&_textures.pool, texture_id);
   SDL_Rect src;
   src.x = 0;
   src.y = 0;
@@ -305,66 +1474,51 @@ Graphic_CreateFullTextureSprite(Id texture_id, SDL_Rect dest)
     &src.h
   );
 
-  _camera.bounds.dirty = true;
-  return Graphic_CreateTilesetSprite(texture_id, src, dest);
+  Id id = Graphic_CreateTilesetSprite(texture_id, src, dest);
+  _sprites.info[Pool_GetIndex(&_sprites.pool, id)].wholeTexture = true;
+  return id;
 }
 
 void
 Graphic_SetSpriteSize(Id id, int w, int h) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
 
   _sprites.rectF[index].w = w;
   _sprites.rectF[index].h = h;
-  _sprites.sprite[index].dest.w = w * _camera.zoom;
-  _sprites.sprite[index].dest.h = h * _camera.zoom;
+  _sprites.sprite[index].dest.w = w * transform.zoom;
+  _sprites.sprite[index].dest.h = h * transform.zoom;
   _camera.bounds.dirty = true;
 }
 
 void
 Graphic_TranslateSprite(Id id, int x, int y) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
 
   _sprites.rectF[index].x = (int) _sprites.rectF[index].x + x;
   _sprites.rectF[index].y = (int) _sprites.rectF[index].y + y;
-  _sprites.sprite[index].dest.x += x * _camera.zoom;
-  _sprites.sprite[index].dest.y += y * _camera.zoom;
+  _sprites.sprite[index].dest.x += x * transform.zoom;
+  _sprites.sprite[index].dest.y += y * transform.zoom;
   _camera.bounds.dirty = true;
 }
 
 void
 Graphic_DeleteSprite(Id id) 
 {
-  Index index, last;
-
-  GET_INDEX_FROM_ID(_sprites, id, index);
-
-  _sprites.indexes[id] = _sprites.next_free_index;
-  _sprites.next_free_index = id;
+  Graphic_StopClip(id);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  if (_sprites.info[index].ownsTexture) {
+    SDL_DestroyTexture(_sprites.sprite[index].texture);
+  }
 
   if (index < _sprites.totalActive) {
-    last = --_sprites.totalActive;
-    if (id != _sprites.ids[last]) {
-      _sprites.ids[index] = _sprites.ids[last];
-      _sprites.indexes[_sprites.ids[last]] = index;
-    }
-    _sprites.sprite[index] = _sprites.sprite[last];
-    _sprites.rectF[index] = _sprites.rectF[last];
-    index = last;
-    id = _sprites.ids[last];
+    index = _deactivateSprite(index);
   } 
 
-
-  last = --_sprites.total;
-  if (id != _sprites.ids[last]) {
-    _sprites.ids[index] = _sprites.ids[last];
-    _sprites.indexes[_sprites.ids[last]] = index;
-  }
-  _sprites.sprite[index] = _sprites.sprite[last];
-  _sprites.rectF[index] = _sprites.rectF[last];
+  Pool_DeleteAt(&_sprites.pool, index);
   _camera.bounds.dirty = true;
 }
 
@@ -372,8 +1526,8 @@ Graphic_DeleteSprite(Id id)
 void 
 Graphic_QueryTextureSize(Id texture_id, int* w, int* h) 
 {
-  Id index;
-  GET_INDEX_FROM_ID(_textures, texture_id, index);
+  Graphic_WaitTexture(texture_id);
+  Index index = Pool_GetIndex(&_textures.pool, texture_id);
   SDL_Texture* texture = _textures.textures[index];
   SDL_QueryTexture(texture, NULL, NULL, w, h);
 }
@@ -381,13 +1535,32 @@ Graphic_QueryTextureSize(Id texture_id, int* w, int* h)
 void
 Graphic_Quit()
 {
+  _stopDecoders();
+  Pack_Close(&_pack);
   SDL_DestroyRenderer(_renderer);
-  SDL_DestroyWindow(_window);
-  for (Index i = 0; i < _textures.total; i++ ) {
+  if (_window) {
+    SDL_DestroyWindow(_window);
+  }
+  if (_surface) {
+    SDL_FreeSurface(_surface);
+  }
+  _clearTileLayers();
+  Pool_Free(&_tileLayers.pool);
+  for (Index i = 0; i < _textures.pool.total; i++ ) {
     if (_textures.textures[i]) {
       SDL_DestroyTexture(_textures.textures[i]);
     }
   }
+  for (Index i = 0; i < _sprites.pool.total; i++) {
+    if (_sprites.info[i].ownsTexture) {
+      SDL_DestroyTexture(_sprites.sprite[i].texture);
+    }
+  }
+  Pool_Free(&_sprites.pool);
+  Pool_Free(&_textures.pool);
+  Pool_Free(&_animations.pool);
+  Pool_Free(&_clips.pool);
+  free(_clips.frames);
 
   TTF_CloseFont(_font);
   TTF_Quit();
@@ -399,24 +1572,37 @@ Graphic_Quit()
 void 
 Graphic_QueryWindowSize(int* w, int* h)
 {
-  assert(_window != NULL);
-  SDL_GetWindowSize(_window, w, h);
+  *w = _windowWidth;
+  *h = _windowHeight;
+}
+
+void
+Graphic_ResizeWindow(int w, int h)
+{
+  if (w == _windowWidth && h == _windowHeight) {
+    return;
+  }
+
+  _windowWidth = w;
+  _windowHeight = h;
+  // Zooming is centered on the window, so the sprites have to follow it.
+  Graphic_ZoomSprites(1.0);
 }
 
 void Graphic_QueryPosition(Id id, int * x, int* y)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
-  (*x) = _sprites.sprite[index].dest.x / _camera.zoom + _camera.x;
-  (*y) = _sprites.sprite[index].dest.y / _camera.zoom + _camera.y;
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
+  (*x) = _sprites.sprite[index].dest.x / transform.zoom + transform.x;
+  (*y) = _sprites.sprite[index].dest.y / transform.zoom + transform.y;
 }
 
 void Graphic_SetPosition(Id id, int x, int y)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
-  _sprites.sprite[index].dest.x = (x - _camera.x) * _camera.zoom;
-  _sprites.sprite[index].dest.y = (y - _camera.y) * _camera.zoom;
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
+  _sprites.sprite[index].dest.x = (x - transform.x) * transform.zoom;
+  _sprites.sprite[index].dest.y = (y - transform.y) * transform.zoom;
   _sprites.rectF[index].x = x;
   _sprites.rectF[index].y = y;
   _camera.bounds.dirty = true;
@@ -426,11 +1612,7 @@ void Graphic_SetPosition(Id id, int x, int y)
 Id 
 Graphic_CreateTextTexture(const char * const text, SDL_Color color)
 {
-  Index index;
-  Id id;
-  GET_NEXT_ID(_textures, id, index, MAX_TEXTURES);
-
-  _textures.textures[index] = Graphic_CreateTextSDLTexture(text, color, NULL, NULL);
+  Id id = _createTexture(Graphic_CreateTextSDLTexture(text, color, NULL, NULL), false);
   _camera.bounds.dirty = true;
   return id;
 }
@@ -450,12 +1632,14 @@ Graphic_CreateText(
   src.y = 0;
   src.w = w;
   src.h = h;
-  dest.x = (x - _camera.x) * _camera.zoom;
-  dest.y = (y - _camera.x) * _camera.zoom;
-  dest.w = w * _camera.zoom;
-  dest.h = h * _camera.zoom;
+  dest.x = x;
+  dest.y = y;
+  dest.w = w;
+  dest.h = h;
   _camera.bounds.dirty = true;
-  return _createTilesetSprite(texture, src, dest);
+  Id id = _createTilesetSprite(texture, src, dest);
+  _sprites.info[Pool_GetIndex(&_sprites.pool, id)].ownsTexture = true;
+  return id;
 }
 
 Id 
@@ -495,10 +1679,11 @@ Graphic_SetText(
   int y,
   SDL_Color color) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
-
-  SDL_DestroyTexture(_sprites.sprite[index].texture); 
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  if (_sprites.info[index].ownsTexture) {
+    SDL_DestroyTexture(_sprites.sprite[index].texture); 
+  }
+  _sprites.info[index].ownsTexture = true;
 
   SDL_Rect src;
   src.x = 0;
@@ -512,70 +1697,133 @@ Graphic_SetText(
   _sprites.sprite[index].src = src;
   _sprites.rectF[index].x = x;
   _sprites.rectF[index].y = y;
-  _sprites.sprite[index].dest.x = (x - _camera.x) * _camera.zoom;
-  _sprites.sprite[index].dest.y = (y - _camera.x) * _camera.zoom;
-  _sprites.sprite[index].dest.w = src.w * _camera.zoom;
-  _sprites.sprite[index].dest.h = src.h * _camera.zoom;
+  _sprites.rectF[index].w = src.w;
+  _sprites.rectF[index].h = src.h;
+  SDL_Rect dest = { x, y, src.w, src.h };
+  _sprites.sprite[index].dest = _applyCameraToDest(
+    _sprites.info[index].layer, 
+    dest
+  );
   _camera.bounds.dirty = true;
 }
 
 void 
 Graphic_DeleteText(Id id)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Graphic_DeleteSprite(id);
+}
 
-  SDL_DestroyTexture(_sprites.sprite[index].texture);
+void
+Graphic_OpenScope()
+{
+  assert(_scope < UCHAR_MAX);
+  _scope++;
+}
 
-  Graphic_DeleteSprite(id);
-  _camera.bounds.dirty = true;
+/*
+ * Every pool is walked once. Deleting pulls an element that wasn't visited
+ * yet into the current slot, so the index only moves past those kept.
+ */
+void
+Graphic_CloseScope()
+{
+  assert(_scope > 0);
+
+  for (Index i = 0; i < _sprites.pool.total; ) {
+    if (_sprites.info[i].scope < _scope) {
+      i++;
+      continue;
+    }
+    Graphic_DeleteSprite(_sprites.pool.ids[i]);
+  }
+
+  for (Index i = 0; i < _tileLayers.pool.total; ) {
+    if (_tileLayers.layers[i].scope < _scope) {
+      i++;
+      continue;
+    }
+    Graphic_DeleteTileLayer(_tileLayers.pool.ids[i]);
+  }
+
+  // Their sprites are gone, so nothing needs to be looked for.
+  for (Index i = 0; i < _textures.pool.total; ) {
+    if (_textures.scope[i] < _scope) {
+      i++;
+      continue;
+    }
+    _cancelDecodes(_textures.pool.ids[i], false);
+    SDL_DestroyTexture(_textures.textures[i]);
+    Pool_DeleteAt(&_textures.pool, i);
+  }
+
+  for (Index i = 0; i < _clips.pool.total; ) {
+    if (_clips.clips[i].scope < _scope) {
+      i++;
+      continue;
+    }
+    Graphic_DeleteClip(_clips.pool.ids[i]);
+  }
+
+  _scope--;
+}
+
+void
+Graphic_AdoptTexture(Id id)
+{
+  _textures.scope[Pool_GetIndex(&_textures.pool, id)] = _scope;
 }
 
 void
 Graphic_Clear()
 {
-  for (Index i = 0; i < _textures.total; i++) {
+  _cancelDecodes(VOID_ID, true);
+  _clearTileLayers();
+  for (Index i = 0; i < _textures.pool.total; i++) {
     SDL_DestroyTexture(_textures.textures[i]);
   }
 
-  /*
-  for (Index i = 0; i < _sprites.total; i++) {
-    SDL_DestroyTexture(_sprites.sprite[i].texture);
+  for (Index i = 0; i < _sprites.pool.total; i++) {
+    if (_sprites.info[i].ownsTexture) {
+      SDL_DestroyTexture(_sprites.sprite[i].texture);
+    }
   }
-  */
 
-  INIT_STRUCT_FOR_DOD_FREE_LIST(_sprites, MAX_SPRITES);
-  INIT_STRUCT_FOR_DOD_FREE_LIST(_textures, MAX_TEXTURES);
+  Pool_Clear(&_sprites.pool);
+  Pool_Clear(&_textures.pool);
+  Pool_Clear(&_animations.pool);
+  Pool_Clear(&_clips.pool);
+  _clips.totalFrames = 0;
   _sprites.totalActive = 0;
-  _sprites.total = 0;
-  _textures.total = 0;
+  memset(_sprites.layerStarts, 0, sizeof(_sprites.layerStarts));
   _camera.bounds.dirty = true;
 }
 
 void 
 Graphic_SetSpriteSrcAndDest(Id id, SDL_Rect src, SDL_Rect dest)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   _sprites.rectF[index] = _convertRectToRectF(dest);
   _sprites.sprite[index].src = src;
-  _sprites.sprite[index].dest = _applyCameraToDest(dest);
+  _sprites.info[index].wholeTexture = false;
+  _sprites.sprite[index].dest = _applyCameraToDest(
+    _sprites.info[index].layer, 
+    dest
+  );
   _camera.bounds.dirty = true;
 }
 
 void
 Graphic_SetSpriteSrcRect(Id id, SDL_Rect src) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   _sprites.sprite[index].src = src;
+  _sprites.info[index].wholeTexture = false;
 }
 
 void 
 Graphic_CenterSpriteOnScreen(Id id) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -591,8 +1839,7 @@ Graphic_CenterSpriteOnScreen(Id id)
 void 
 Graphic_CenterSpriteOnScreenWidth(Id id) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -606,8 +1853,7 @@ Graphic_CenterSpriteOnScreenWidth(Id id)
 void 
 Graphic_CenterSpriteOnScreenHeight(Id id) 
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -621,8 +1867,7 @@ Graphic_CenterSpriteOnScreenHeight(Id id)
 void
 Graphic_CenterSpriteOnScreenWithOffset(Id id, int x, int y)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -638,8 +1883,7 @@ Graphic_CenterSpriteOnScreenWithOffset(Id id, int x, int y)
 void
 Graphic_CenterSpriteOnScreenWidthWithOffset(Id id, int x)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -653,8 +1897,7 @@ Graphic_CenterSpriteOnScreenWidthWithOffset(Id id, int x)
 void
 Graphic_CenterSpriteOnScreenHeightWithOffset(Id id, int y)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
@@ -668,8 +1911,7 @@ Graphic_CenterSpriteOnScreenHeightWithOffset(Id id, int y)
 void 
 Graphic_ResizeSpriteToScreen(Id id)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   int backgroundTextureWidth;
   int backgroundTextureHeight;
   SDL_QueryTexture(
@@ -721,85 +1963,85 @@ Graphic_CreateSolidTexture(Uint32 color)
   SDL_Texture* texture = SDL_CreateTextureFromSurface(_renderer, surface);
   SDL_FreeSurface(surface);
 
-  Id textureId;
-  Index textureIndex;
-  GET_NEXT_ID(_textures, textureId, textureIndex, MAX_TEXTURES);
-  _textures.textures[textureIndex] = texture;
-
-  return textureId;
+  return _createTexture(texture, false);
 }
 
 void
 Graphic_QuerySpriteDest(Id id, SDL_Rect *rect)
 {
-  unsigned int index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
   *rect = _sprites.sprite[index].dest;
-  rect->x /= _camera.zoom;
-  rect->y /= _camera.zoom;
-  rect->w /= _camera.zoom;
-  rect->h /= _camera.zoom;
-  rect->x += _camera.x;
-  rect->y += _camera.y;
+  rect->x /= transform.zoom;
+  rect->y /= transform.zoom;
+  rect->w /= transform.zoom;
+  rect->h /= transform.zoom;
+  rect->x += transform.x;
+  rect->y += transform.y;
 }
 
 void 
 Graphic_SetSpriteToInactive(Id id)
 {
-  Index index, last;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   if (index >= _sprites.totalActive) {
     return;
   }
 
-  last = --_sprites.totalActive;
-  if (id != _sprites.ids[last]) {
-    _sprites.ids[index] = _sprites.ids[last];
-    _sprites.indexes[_sprites.ids[last]] = index;
-    _sprites.ids[last] = id;
-    _sprites.indexes[id] = last;
-  }
-  _Sprite tmp = _sprites.sprite[last];
-  RectF tRectF = _sprites.rectF[last];
-  _sprites.sprite[last] = _sprites.sprite[index];
-  _sprites.rectF[last] = _sprites.rectF[index];
-  _sprites.sprite[index] = tmp;
-  _sprites.rectF[index] = tRectF;
-  _camera.bounds.dirty = true;
+  _deactivateSprite(index);
 }
 
 void 
 Graphic_SetSpriteToActive(Id id)
 {
-  Index index, last;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   if (index < _sprites.totalActive) {
     return;
   }
 
-  last = _sprites.totalActive++;
-  if (id != _sprites.ids[last]) {
-    _sprites.ids[index] = _sprites.ids[last];
-    _sprites.indexes[_sprites.ids[last]] = index;
-    _sprites.ids[last] = id;
-    _sprites.indexes[id] = last;
+  _activateSprite(index);
+}
+
+bool
+Graphic_IsSpriteActive(Id id)
+{
+  Index index = Pool_GetIndex(&_sprites.pool, id);
+  return index < _sprites.totalActive;
+}
+
+bool
+Graphic_CheckSprites()
+{
+  if (_sprites.totalActive > _sprites.pool.total) {
+    return false;
+  }
+
+  for (Index i = 0; i < _sprites.totalActive; i++) {
+    Graphic_Layer layer = _sprites.info[i].layer;
+    if (i < _sprites.layerStarts[layer] || i >= _getLayerEnd(layer)) {
+      return false;
+    }
   }
-  _Sprite tmp = _sprites.sprite[last];
-  RectF tRectF = _sprites.rectF[last];
-  _sprites.sprite[last] = _sprites.sprite[index];
-  _sprites.rectF[last] = _sprites.rectF[index];
-  _sprites.sprite[index] = tmp;
-  _sprites.rectF[index] = tRectF;
-  _camera.bounds.dirty = true;
+
+  return Pool_Check(&_sprites.pool);
+}
+
+void
+Graphic_SetLayer(Graphic_Layer layer)
+{
+  assert(layer < Graphic_TotalLayers);
+  _layer = layer;
 }
 
 void
 Graphic_SetSpriteDest(Id id, SDL_Rect dest)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
 
-  _sprites.sprite[index].dest = _applyCameraToDest(dest);
+  _sprites.sprite[index].dest = _applyCameraToDest(
+    _sprites.info[index].layer, 
+    dest
+  );
   _sprites.rectF[index] = _convertRectToRectF(dest);
   _camera.bounds.dirty = true;
 }
@@ -807,8 +2049,7 @@ Graphic_SetSpriteDest(Id id, SDL_Rect dest)
 void
 Graphic_CenterSpriteInRect(Id id, SDL_Rect rect)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   int w, h;
   SDL_QueryTexture(
     _sprites.sprite[index].texture, 
@@ -824,11 +2065,12 @@ Graphic_CenterSpriteInRect(Id id, SDL_Rect rect)
   rectF.w = w;
   rectF.h = h;
   SDL_Rect dest;
+  _Transform transform = _getTransform(_sprites.info[index].layer);
 
-  dest.x = (rectF.x - _camera.x) * _camera.zoom;
-  dest.y = (rectF.y - _camera.y) * _camera.zoom;
-  dest.w = rectF.w * _camera.zoom;
-  dest.h = rectF.h * _camera.zoom;
+  dest.x = (rectF.x - transform.x) * transform.zoom;
+  dest.y = (rectF.y - transform.y) * transform.zoom;
+  dest.w = rectF.w * transform.zoom;
+  dest.h = rectF.h * transform.zoom;
 
   _sprites.sprite[index].dest = dest;
   _sprites.rectF[index] = rectF;
@@ -838,8 +2080,7 @@ Graphic_CenterSpriteInRect(Id id, SDL_Rect rect)
 void
 Graphic_CenterSpriteInRectButKeepRatio(Id id, SDL_Rect rect)
 {
-  Index index;
-  GET_INDEX_FROM_ID(_sprites, id, index);
+  Index index = Pool_GetIndex(&_sprites.pool, id);
   int w, h;
   SDL_QueryTexture(
     _sprites.sprite[index].texture, 
@@ -851,9 +2092,10 @@ Graphic_CenterSpriteInRectButKeepRatio(Id id, SDL_Rect rect)
   SDL_Rect dest;
 
   _sprites.rectF[index] = _convertRectToRectF(rect);
+  _Transform transform = _getTransform(_sprites.info[index].layer);
 
-  dest.x = (rect.x - _camera.x) * _camera.zoom;
-  dest.y = (rect.y - _camera.y) * _camera.zoom;
+  dest.x = (rect.x - transform.x) * transform.zoom;
+  dest.y = (rect.y - transform.y) * transform.zoom;
   dest.w = rect.w;
   dest.h = rect.h;
 
@@ -871,11 +2113,14 @@ Id
 Graphic_CreateInactiveSprite(Id textureId)
 {
   Index index;
-  Id id;
-  GET_NEXT_ID(_sprites, id, index, MAX_SPRITES);
+  Id id = Pool_Create(&_sprites.pool, &index);
+  _sprites.animation[index] = VOID_ID;
+  _sprites.info[index].scope = _scope;
+  _sprites.info[index].layer = _layer;
+  _sprites.info[index].ownsTexture = false;
+  _sprites.info[index].wholeTexture = true;
   
-  Index textureIndex;
-  GET_INDEX_FROM_ID(_textures, textureId, textureIndex);
+  Index textureIndex = Pool_GetIndex(&_textures.pool, textureId);
 
   _sprites.sprite[index].src.x = 0;
   _sprites.sprite[index].src.y = 0;
@@ -903,39 +2148,22 @@ Graphic_CreateInactiveSprite(Id textureId)
 void 
 Graphic_DeleteTexture(Id id)
 {
-  Index idx, last;
-  DELETE_DOD_ELEMENT_BY_ID(_textures, id, idx, last);
+  _cancelDecodes(id, false);
+  Index idx = Pool_GetIndex(&_textures.pool, id);
   SDL_Texture* ptr = _textures.textures[idx];
+  Pool_DeleteAt(&_textures.pool, idx);
   SDL_DestroyTexture(ptr);
   
-  for (Index i = 0; i < _sprites.total; i++)
+  for (Index i = 0; i < _sprites.pool.total; )
   {
     if (_sprites.sprite[i].texture != ptr)
     {
+      i++;
       continue;
     }
 
-    Index spriteId, spriteLast;
-    DELETE_DOD_ELEMENT_BY_INDEX(_sprites, spriteId, i, spriteLast);
-    if (i < _sprites.totalActive - 1)
-    {
-      _sprites.totalActive--;
-      _sprites.sprite[i] = _sprites.sprite[_sprites.totalActive];
-      _sprites.rectF[i] = _sprites.rectF[_sprites.totalActive];
-      _sprites.sprite[_sprites.totalActive] = _sprites.sprite[spriteLast];
-      _sprites.rectF[_sprites.totalActive] = _sprites.rectF[spriteLast];
-    } 
-    else 
-    { 
-      if (i == _sprites.totalActive - 1) 
-      {
-        _sprites.totalActive--;
-      }
-      _sprites.sprite[i] = _sprites.sprite[spriteLast];
-      _sprites.rectF[i] = _sprites.rectF[spriteLast];
-    }
-    i--;
-    _camera.bounds.dirty = true;
+    // Deleting pulls a sprite that was not visited yet into slot i.
+    Graphic_DeleteSprite(_sprites.pool.ids[i]);
   }
 }
 
@@ -944,7 +2172,8 @@ Graphic_TranslateAllSprite(int dx, int dy)
 {
   _camera.bounds.x += dx * _camera.zoom;
   _camera.bounds.y += dy * _camera.zoom;
-  for (Index i = 0; i < _sprites.totalActive; i++) {
+  Index end = _sprites.layerStarts[Graphic_ScreenLayer];
+  for (Index i = 0; i < end; i++) {
     _sprites.sprite[i].dest.x += dx * _camera.zoom;
     _sprites.sprite[i].dest.y += dy * _camera.zoom;
   }
@@ -953,41 +2182,16 @@ Graphic_TranslateAllSprite(int dx, int dy)
 void 
 Graphic_SetSpriteToBeAfterAnother(Id id, Id other)
 {
-  Index idx, otherIdx;
-  GET_INDEX_FROM_ID(_sprites, id, idx);
-  GET_INDEX_FROM_ID(_sprites, other, otherIdx);
+  Index idx = Pool_GetIndex(&_sprites.pool, id);
+  Index otherIdx = Pool_GetIndex(&_sprites.pool, other);
+  assert(_sprites.info[idx].layer == _sprites.info[otherIdx].layer);
+  assert((idx < _sprites.totalActive) == (otherIdx < _sprites.totalActive));
 
-  _Sprite sprite = _sprites.sprite[idx];
-  RectF rectF = _sprites.rectF[idx];
   if (idx == otherIdx) {
     return;
   }
 
-  if (idx < otherIdx) {
-    for (Index i = idx; i < otherIdx; i++) {
-      _sprites.sprite[i] = _sprites.sprite[i + 1];
-      _sprites.rectF[i] = _sprites.rectF[i + 1];
-      _sprites.ids[i] = _sprites.ids[i + 1];
-      _sprites.indexes[_sprites.ids[i]] = i;
-    }
-
-    _sprites.sprite[otherIdx] = sprite;
-    _sprites.rectF[otherIdx] = rectF;
-    _sprites.ids[otherIdx] = id;
-    _sprites.indexes[id] = otherIdx;
-  } else {
-    for (Index i = idx; i > otherIdx + 1; i--) {
-      _sprites.sprite[i] = _sprites.sprite[i - 1];
-      _sprites.rectF[i] = _sprites.rectF[i - 1];
-      _sprites.ids[i] = _sprites.ids[i - 1];
-      _sprites.indexes[_sprites.ids[i]] = i;
-    }
-
-    _sprites.sprite[otherIdx + 1] = sprite;
-    _sprites.rectF[otherIdx + 1] = rectF;
-    _sprites.ids[otherIdx + 1] = id;
-    _sprites.indexes[id] = otherIdx + 1;
-  }
+  Pool_Move(&_sprites.pool, idx, idx < otherIdx ? otherIdx : otherIdx + 1);
 }
 
 void 
@@ -1002,7 +2206,10 @@ Graphic_ZoomSprites(double zoom)
   int w, h;
   Graphic_QueryWindowSize(&w, &h);
 
-  for (Index i = 0; i < _sprites.total; i++) {
+  for (Index i = 0; i < _sprites.pool.total; i++) {
+    if (_sprites.info[i].layer == Graphic_ScreenLayer) {
+      continue;
+    }
     _sprites.sprite[i].dest.x = 
       (_sprites.rectF[i].x - _camera.x) * _camera.zoom - 
       w / 2 * (_camera.zoom - 1);
@@ -1062,19 +2269,37 @@ Graphic_GetCameraZoom()
   return _camera.zoom;
 }
 
+void
+Graphic_QueryCameraView(SDL_Rect* view)
+{
+  int w, h;
+  Graphic_QueryWindowSize(&w, &h);
+
+  // Inverse of _worldToScreen for the corners of the window.
+  view->x = floor(_camera.x + w / 2 * (_camera.zoom - 1) / _camera.zoom);
+  view->y = floor(_camera.y + h / 2 * (_camera.zoom - 1) / _camera.zoom);
+  view->w = ceil(w / _camera.zoom) + 1;
+  view->h = ceil(h / _camera.zoom) + 1;
+}
+
 void 
 Graphic_TranslateSpriteFloat(
   Id id, 
   double x, 
   double y)
 {
-  Index idx;
-  GET_INDEX_FROM_ID(_sprites, id, idx);
+  Index idx = Pool_GetIndex(&_sprites.pool, id);
 
-  int w, h;
-  Graphic_QueryWindowSize(&w, &h);
   _sprites.rectF[idx].x += x;
   _sprites.rectF[idx].y += y;
+  if (_sprites.info[idx].layer == Graphic_ScreenLayer) {
+    _sprites.sprite[idx].dest.x = _sprites.rectF[idx].x;
+    _sprites.sprite[idx].dest.y = _sprites.rectF[idx].y;
+    return;
+  }
+
+  int w, h;
+  Graphic_QueryWindowSize(&w, &h);
   _sprites.sprite[idx].dest.x = 
     (_sprites.rectF[idx].x - _camera.x) * _camera.zoom - 
     w / 2 * (_camera.zoom - 1);
@@ -1099,66 +2324,77 @@ Graphic_CenterCamera()
   Graphic_TranslateAllSprite(dx, dy);
 }
 
-Id 
-Graphic_CreateSpriteFromSprites(Sprite *start, Sprite *end)
+Id
+Graphic_CreateTextureFromSprites(
+  const Sprite* start, 
+  const Sprite* end, 
+  SDL_Rect* bounds
+)
 {
-  if (start == NULL) {
-    return VOID_ID;
-  }
+  assert(start < end);
 
   int left = start->dest.x; 
   int top = start->dest.y;
   int right = left + start->dest.w;
   int bottom = top + start->dest.h;
-  for (Sprite* curr = start + 1; curr < end; curr++) {
-    if (curr->dest.x < left) {
-      left = curr->dest.x;
-    }
-
-    if (curr->dest.x + curr->dest.w > right) {
-      right = curr->dest.x + curr->dest.w;
-    }
-
-    if (curr->dest.y < top) {
-      top = curr->dest.y;
-    }
-
-    if (curr->dest.y + curr->dest.h > bottom) {
-      bottom = curr->dest.y + curr->dest.h;
-    }
+  for (const Sprite* curr = start + 1; curr < end; curr++) {
+    left = SDL_min(left, curr->dest.x);
+    top = SDL_min(top, curr->dest.y);
+    right = SDL_max(right, curr->dest.x + curr->dest.w);
+    bottom = SDL_max(bottom, curr->dest.y + curr->dest.h);
+  }
+  bounds->x = left;
+  bounds->y = top;
+  bounds->w = right - left;
+  bounds->h = bottom - top;
+
+  Id id = _createTexture(NULL, false);
+  if (_backend == Graphic_NullBackend) {
+    return id;
   }
 
+  // Around the sprites, the slice must stay transparent.
   SDL_Texture* texture = SDL_CreateTexture(
     _renderer, 
-    SDL_GetWindowPixelFormat(_window), 
+    SDL_PIXELFORMAT_ARGB8888, 
     SDL_TEXTUREACCESS_TARGET,
-    right - left, 
-    bottom - top
+    bounds->w, 
+    bounds->h
   );
+  if (texture == NULL) {
+    fprintf(stderr, "Baked texture couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    exit(EXIT_FAILURE);
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  _textures.textures[Pool_GetIndex(&_textures.pool, id)] = texture;
 
-  SDL_Texture* t = SDL_GetRenderTarget(_renderer);
+  SDL_Texture* target = SDL_GetRenderTarget(_renderer);
   SDL_SetRenderTarget(_renderer, texture);
   SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0x00);
   SDL_RenderClear(_renderer);
-  for (Sprite* curr = start; curr < end; curr++) {
-    Index textureIdx;
-    GET_INDEX_FROM_ID(_textures, curr->textureId, textureIdx);
-    curr->dest.x -= left;
-    curr->dest.y -= top;
-    SDL_RenderCopy(_renderer, _textures.textures[textureIdx], &curr->src, &curr->dest);
-  }
-  SDL_RenderPresent(_renderer);
-  SDL_SetRenderTarget(_renderer, t);
-
-  SDL_Rect dest, src;
-  dest.x = left;
-  dest.y = top;
-  src.x = 0;
-  src.y = 0;
-  src.w = dest.w = right - left;
-  src.h = dest.h = bottom - top;
+  for (const Sprite* curr = start; curr < end; curr++) {
+    Graphic_WaitTexture(curr->textureId);
+    Index textureIdx = Pool_GetIndex(&_textures.pool, curr->textureId);
+    SDL_Rect dest = curr->dest;
+    dest.x -= left;
+    dest.y -= top;
+    SDL_RenderCopy(_renderer, _textures.textures[textureIdx], &curr->src, &dest);
+  }
+  SDL_SetRenderTarget(_renderer, target);
+  return id;
+}
+
+Id 
+Graphic_CreateSpriteFromSprites(Sprite *start, Sprite *end)
+{
+  if (start == NULL) {
+    return VOID_ID;
+  }
 
-  return _createTilesetSprite(texture, src, dest);
+  SDL_Rect dest;
+  Id texture = Graphic_CreateTextureFromSprites(start, end, &dest);
+  SDL_Rect src = { 0, 0, dest.w, dest.h };
+  return Graphic_CreateTilesetSprite(texture, src, dest);
 }
 
 void 
@@ -1173,8 +2409,10 @@ Graphic_FillRect(SDL_Rect dest, Uint32 color)
     color >> 8 & 0xFF, 
     color & 0xFF
   );
-  printf("x: %d, y: %d, w: %d, h: %d\n", dest.x, dest.y, dest.w, dest.h);
-  SDL_RenderFillRect(_renderer, &dest);
+  _stats.drawCalls++;
+  if (_backend != Graphic_NullBackend) {
+    SDL_RenderFillRect(_renderer, &dest);
+  }
   SDL_SetRenderDrawColor(
     _renderer, 
     prevR,
@@ -1184,19 +2422,126 @@ Graphic_FillRect(SDL_Rect dest, Uint32 color)
   );
 }
 
+/* The software renderer has no custom blend modes, it blends instead. */
+static void
+_setPremultipliedBlendMode(SDL_Texture* texture)
+{
+  SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+    SDL_BLENDFACTOR_ONE, 
+    SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, 
+    SDL_BLENDOPERATION_ADD, 
+    SDL_BLENDFACTOR_ONE, 
+    SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, 
+    SDL_BLENDOPERATION_ADD
+  );
+  if (SDL_SetTextureBlendMode(texture, premultiplied)) {
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  }
+}
+
+SDL_Texture*
+Graphic_CreateTargetSDLTexture(int w, int h)
+{
+  SDL_Texture* texture = SDL_CreateTexture(
+    _renderer, 
+    SDL_PIXELFORMAT_ARGB8888, 
+    SDL_TEXTUREACCESS_TARGET, 
+    w, 
+    h
+  );
+  if (texture == NULL) {
+    fprintf(stderr, "Target texture couldn't be created! SDL_Error: %s\n", SDL_GetError());
+    return NULL;
+  }
+
+  // Blending onto a clear target leaves its colours premultiplied.
+  _setPremultipliedBlendMode(texture);
+  return texture;
+}
+
+void
+Graphic_BeginTarget(SDL_Texture* target)
+{
+  assert(SDL_GetRenderTarget(_renderer) == NULL);
+  if (_backend == Graphic_NullBackend) {
+    return;
+  }
+
+  SDL_SetRenderTarget(_renderer, target);
+  SDL_SetRenderDrawColor(_renderer, 0x00, 0x00, 0x00, 0x00);
+  SDL_RenderClear(_renderer);
+}
+
+void
+Graphic_EndTarget()
+{
+  if (_backend == Graphic_NullBackend) {
+    return;
+  }
+
+  SDL_SetRenderTarget(_renderer, NULL);
+}
+
 void 
 Graphic_RenderCopy(SDL_Texture* texture, SDL_Rect* src, SDL_Rect* dest)
 {
-  SDL_RenderCopy(_renderer, texture, src, dest);
+  _stats.drawCalls++;
+  if (_backend != Graphic_NullBackend) {
+    SDL_RenderCopy(_renderer, texture, src, dest);
+  }
+}
+
+static SDL_Texture*
+_createPackedTexture(const Pack_Image* image)
+{
+  SDL_Texture* texture = SDL_CreateTexture(
+    _renderer, 
+    _pack.header->format, 
+    SDL_TEXTUREACCESS_STATIC, 
+    image->w, 
+    image->h
+  );
+  if (
+      texture == NULL || 
+      SDL_UpdateTexture(texture, NULL, Pack_GetPixels(&_pack, image), image->pitch)
+  ) {
+    fprintf(
+      stderr, "Texture %s could not be loaded! SDL_Error: %s\n", 
+      image->name, 
+      SDL_GetError()
+    );
+    exit(EXIT_FAILURE);
+  }
+
+  // Keyed pixels are either opaque or clear, so the fallback is exact.
+  _setPremultipliedBlendMode(texture);
+  return texture;
+}
+
+bool
+Graphic_OpenPack(const char* const filename)
+{
+  Pack_Close(&_pack);
+  if (!Pack_Open(&_pack, filename)) {
+    return false;
+  }
+  if (SDL_BYTESPERPIXEL(_pack.header->format) != PACK_PIXEL_BYTES) {
+    fprintf(stderr, "Asset pack %s has an unsupported pixel format!\n", filename);
+    Pack_Close(&_pack);
+    return false;
+  }
+  return true;
 }
 
 SDL_Texture*
 Graphic_CreateSDLTexture(const char* const filename)
 {
-  SDL_Surface* surface = IMG_Load(filename);
-  Uint32 colorkey = SDL_MapRGB(surface->format, 0xff, 0, 0xff);
-  SDL_SetColorKey(surface, SDL_TRUE, colorkey);
+  const Pack_Image* image = Pack_Find(&_pack, filename);
+  if (image) {
+    return _createPackedTexture(image);
+  }
 
+  SDL_Surface* surface = _decodeImage(filename);
   SDL_Texture *texture = SDL_CreateTextureFromSurface(_renderer, surface);
   SDL_FreeSurface(surface);
   if (texture == NULL) {
@@ -1216,3 +2561,153 @@ Graphic_QuerySDLTextureSize(SDL_Texture* texture, int* w, int* h)
 {
   SDL_QueryTexture(texture, NULL, NULL, w, h);
 }
+
+Id
+Graphic_CreateTileLayer(
+  Id textureId,
+  Graphic_TileProjection projection,
+  int width,
+  int height,
+  int tileWidth,
+  int tileHeight,
+  const SDL_Rect* palette,
+  int paletteSize)
+{
+  assert(Pool_Has(&_textures.pool, textureId));
+  assert(width > 0 && height > 0 && paletteSize < VOID_SMALL_ID);
+
+  Index index;
+  Id id = Pool_Create(&_tileLayers.pool, &index);
+  _TileLayer* layer = &_tileLayers.layers[index];
+
+  layer->textureId = textureId;
+  layer->scope = _scope;
+  layer->projection = projection;
+  layer->width = width;
+  layer->height = height;
+  layer->tileWidth = tileWidth;
+  layer->tileHeight = tileHeight;
+  layer->chunksWide = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+  layer->chunksHigh = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+  layer->paletteSize = paletteSize;
+  layer->palette = malloc(paletteSize * sizeof(SDL_Rect));
+  layer->chunks = calloc(
+    layer->chunksWide * layer->chunksHigh, 
+    sizeof(_TileChunk)
+  );
+  if (!layer->palette || !layer->chunks) {
+    fprintf(stderr, "Couldn't allocate a %dx%d tile layer!\n", width, height);
+    exit(EXIT_FAILURE);
+  }
+  memcpy(layer->palette, palette, paletteSize * sizeof(SDL_Rect));
+  layer->reach = SDL_max(tileWidth, tileHeight);
+  for (int i = 0; i < paletteSize; i++) {
+    layer->reach = SDL_max(layer->reach, SDL_max(palette[i].w, palette[i].h));
+  }
+
+  _camera.bounds.dirty = true;
+  return id;
+}
+
+void
+Graphic_DeleteTileLayer(Id id)
+{
+  Index index = Pool_GetIndex(&_tileLayers.pool, id);
+  _freeTileLayer(&_tileLayers.layers[index]);
+
+  Index last = _tileLayers.pool.total - 1;
+  Pool_Move(&_tileLayers.pool, index, last);
+  Pool_DeleteAt(&_tileLayers.pool, last);
+  _camera.bounds.dirty = true;
+}
+
+void
+Graphic_SetTileLayerTile(Id id, int x, int y, SmallId tile)
+{
+  Graphic_SetTileLayerTiles(id, x, y, 1, 1, &tile, 1);
+}
+
+void
+Graphic_SetTileLayerTiles(
+  Id id, 
+  int x, 
+  int y, 
+  int w, 
+  int h, 
+  const SmallId* tiles, 
+  int pitch
+)
+{
+  Index index = Pool_GetIndex(&_tileLayers.pool, id);
+  _TileLayer* layer = &_tileLayers.layers[index];
+  assert(x >= 0 && w >= 0 && x + w <= layer->width);
+  assert(y >= 0 && h >= 0 && y + h <= layer->height);
+
+  for (int row = 0; row < h; row++) {
+    const SmallId* source = &tiles[row * pitch];
+    int cy = (y + row) / TILE_CHUNK_SIZE;
+    int offsetY = (y + row) % TILE_CHUNK_SIZE * TILE_CHUNK_SIZE;
+
+    // Copy the row one chunk span at a time.
+    for (int column = 0; column < w; ) {
+      int cx = (x + column) / TILE_CHUNK_SIZE;
+      int offsetX = (x + column) % TILE_CHUNK_SIZE;
+      int span = SDL_min(TILE_CHUNK_SIZE - offsetX, w - column);
+      _TileChunk* chunk = &layer->chunks[cy * layer->chunksWide + cx];
+
+      if (!chunk->tiles) {
+        bool empty = true;
+        for (int i = 0; i < span; i++) {
+          assert(source[column + i] == VOID_SMALL_ID || 
+                 source[column + i] < layer->paletteSize);
+          empty &= source[column + i] == VOID_SMALL_ID;
+        }
+        if (empty) {
+          column += span;
+          continue;
+        }
+
+        size_t bytes = TILE_CHUNK_SIZE * TILE_CHUNK_SIZE * sizeof(SmallId);
+        chunk->tiles = malloc(bytes);
+        if (!chunk->tiles) {
+          fprintf(stderr, "Couldn't allocate the tiles of a chunk!\n");
+          exit(EXIT_FAILURE);
+        }
+        memset(chunk->tiles, 0xFF, bytes);
+      }
+
+      SmallId* current = &chunk->tiles[offsetY + offsetX];
+      size_t bytes = span * sizeof(SmallId);
+      if (memcmp(current, &source[column], bytes)) {
+        memcpy(current, &source[column], bytes);
+        chunk->measured = false;
+        chunk->bakedLevels = 0;
+        _camera.bounds.dirty = true;
+      }
+      column += span;
+    }
+  }
+}
+
+SmallId
+Graphic_GetTileLayerTile(Id id, int x, int y)
+{
+  Index index = Pool_GetIndex(&_tileLayers.pool, id);
+  _TileLayer* layer = &_tileLayers.layers[index];
+  assert(x >= 0 && x < layer->width && y >= 0 && y < layer->height);
+
+  int cx = x / TILE_CHUNK_SIZE;
+  int cy = y / TILE_CHUNK_SIZE;
+  _TileChunk* chunk = &layer->chunks[cy * layer->chunksWide + cx];
+  if (!chunk->tiles) {
+    return VOID_SMALL_ID;
+  }
+  return chunk->tiles[(y % TILE_CHUNK_SIZE) * TILE_CHUNK_SIZE + x % TILE_CHUNK_SIZE];
+}
+
+void
+Graphic_SetTileLayerBudget(size_t bytes)
+{
+  _tileLayers.budget = bytes;
+  _evictTileChunks(0);
+}
@@ -1,3 +1,4 @@
+#include "graphic.h"
 #include "input.h"
 
 #define FLAGS_PER_WORD (sizeof(long) * 8)
@@ -7,6 +8,7 @@
 
 static struct {
   bool quit;
+  bool windowResized;
   unsigned long keyPressed[FLAGS_NUM]; 
   unsigned long keyReleased[FLAGS_NUM]; 
   int x;
@@ -33,6 +35,7 @@ Input_PollInputs()
   }
 
   _state.quit = false;
+  _state.windowResized = false;
 
   _state.mouseButtonReleased = 0;
   int prevX = _state.x, prevY = _state.y;
@@ -48,6 +51,12 @@ Input_PollInputs()
       case SDL_QUIT:
         _state.quit = true;
         break;
+      case SDL_WINDOWEVENT:
+        if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+          Graphic_ResizeWindow(event.window.data1, event.window.data2);
+          _state.windowResized = true;
+        }
+        break;
       case SDL_KEYDOWN:
         _state.keyPressed[i] |= (long) 1 << pos;
         break;
@@ -107,6 +116,18 @@ Input_IsQuitPressed()
   return _state.quit;
 }
 
+bool
+Input_IsWindowResized()
+{
+  return _state.windowResized;
+}
+
+bool
+Input_IsMouseButtonReleased(MouseButton buttons)
+{
+  return _state.mouseButtonReleased & buttons;
+}
+
 bool 
 Input_IsZoneClicked(SDL_Rect zone, MouseButton buttons)
 {
@@ -0,0 +1,279 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LEVEL_USE_MMAP
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef LEVEL_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "game-types.h"
+#include "level.h"
+
+static bool
+_readFile(Level* level, const char* filename)
+{
+#ifdef LEVEL_USE_MMAP
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  posix_madvise(data, info.st_size, POSIX_MADV_WILLNEED);
+
+  level->data = data;
+  level->size = info.st_size;
+  return true;
+#else
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    size = ftell(file);
+  }
+  unsigned char* data = size > 0 ? malloc(size) : NULL;
+  if (
+      data == NULL ||
+      fseek(file, 0, SEEK_SET) != 0 ||
+      fread(data, 1, size, file) != (size_t) size
+  ) {
+    free(data);
+    fclose(file);
+    return false;
+  }
+  fclose(file);
+
+  level->data = data;
+  level->size = size;
+  return true;
+#endif
+}
+
+static const void*
+_getTable(const Level* level, uint32_t offset, uint32_t count, size_t size)
+{
+  if (offset % 4 || offset > level->size) {
+    return NULL;
+  }
+  if (count > (level->size - offset) / size) {
+    return NULL;
+  }
+  return level->data + offset;
+}
+
+static bool
+_checkObjects(const Level_Object* objects, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++) {
+    if (objects[i].tile >= TotalGameTiles) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+_checkCells(const Level* level, uint32_t offset)
+{
+  if (offset == 0) {
+    return true;
+  }
+
+  const uint16_t* cells = _getTable(
+      level,
+      offset,
+      LEVEL_CHUNK_CELLS,
+      sizeof(uint16_t)
+  );
+  if (cells == NULL) {
+    return false;
+  }
+  for (int i = 0; i < LEVEL_CHUNK_CELLS; i++) {
+    if (cells[i] >= TotalGameTiles) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static const char*
+_validate(Level* level)
+{
+  if (level->size < sizeof(Level_Header)) {
+    return "file is too small";
+  }
+
+  const Level_Header* header = (const Level_Header*) level->data;
+  if (memcmp(header->magic, LEVEL_MAGIC, sizeof(header->magic))) {
+    return "not a level file";
+  }
+  if (header->version != LEVEL_VERSION) {
+    return "unsupported version";
+  }
+  if (header->width == 0 || header->height == 0) {
+    return "empty map";
+  }
+  if (header->width > 0xFFFF * LEVEL_CHUNK_SIZE) {
+    return "map is too wide";
+  }
+  if (header->height > 0xFFFF * LEVEL_CHUNK_SIZE) {
+    return "map is too high";
+  }
+  if (header->totalLanes != TotalLanes) {
+    return "wrong number of lanes";
+  }
+
+  level->header = header;
+  level->lanes = _getTable(
+      level,
+      header->lanesOffset,
+      header->totalLanes,
+      sizeof(*level->lanes)
+  );
+  level->spawns = _getTable(
+      level,
+      header->spawnsOffset,
+      header->totalSpawns,
+      sizeof(*level->spawns)
+  );
+  level->objects = _getTable(
+      level,
+      header->objectsOffset,
+      header->totalObjects,
+      sizeof(*level->objects)
+  );
+  level->prefabs = _getTable(
+      level,
+      header->prefabsOffset,
+      header->totalPrefabs,
+      sizeof(*level->prefabs)
+  );
+  level->prefabObjects = _getTable(
+      level,
+      header->prefabObjectsOffset,
+      header->totalPrefabObjects,
+      sizeof(*level->prefabObjects)
+  );
+  level->instances = _getTable(
+      level,
+      header->instancesOffset,
+      header->totalInstances,
+      sizeof(*level->instances)
+  );
+  level->chunks = _getTable(
+      level,
+      header->chunksOffset,
+      header->totalChunks,
+      sizeof(*level->chunks)
+  );
+  if (
+      !level->lanes ||
+      !level->spawns ||
+      !level->objects ||
+      !level->prefabs ||
+      !level->prefabObjects ||
+      !level->instances ||
+      !level->chunks
+  ) {
+    return "table out of bounds";
+  }
+
+  for (uint32_t i = 0; i < header->totalSpawns; i++) {
+    if (level->spawns[i] == NoPath || level->spawns[i] >= TotalPaths) {
+      return "invalid spawn path";
+    }
+  }
+
+  if (
+      !_checkObjects(level->objects, header->totalObjects) ||
+      !_checkObjects(level->prefabObjects, header->totalPrefabObjects)
+  ) {
+    return "invalid object tile";
+  }
+
+  for (uint32_t i = 0; i < header->totalPrefabs; i++) {
+    const Level_Prefab* prefab = &level->prefabs[i];
+    if (
+        prefab->firstObject > header->totalPrefabObjects ||
+        prefab->totalObjects > header->totalPrefabObjects - prefab->firstObject
+    ) {
+      return "prefab objects out of bounds";
+    }
+  }
+
+  for (uint32_t i = 0; i < header->totalInstances; i++) {
+    if (level->instances[i].prefab >= header->totalPrefabs) {
+      return "invalid prefab instance";
+    }
+  }
+
+  uint32_t chunksWide = (header->width + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+  uint32_t chunksHigh = (header->height + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+  for (uint32_t i = 0; i < header->totalChunks; i++) {
+    const Level_Chunk* chunk = &level->chunks[i];
+    if (chunk->x >= chunksWide || chunk->y >= chunksHigh) {
+      return "chunk out of the map";
+    }
+    if (
+        !_checkCells(level, chunk->groundOffset) ||
+        !_checkCells(level, chunk->objectOffset)
+    ) {
+      return "invalid chunk cells";
+    }
+  }
+
+  return NULL;
+}
+
+bool
+Level_Open(Level* level, const char* filename)
+{
+  memset(level, 0, sizeof(*level));
+  if (!_readFile(level, filename)) {
+    fprintf(stderr, "Level %s could not be read!\n", filename);
+    return false;
+  }
+
+  const char* error = _validate(level);
+  if (error) {
+    fprintf(stderr, "Level %s is corrupted: %s!\n", filename, error);
+    Level_Close(level);
+    return false;
+  }
+
+  return true;
+}
+
+void
+Level_Close(Level* level)
+{
+  if (level->data) {
+#ifdef LEVEL_USE_MMAP
+    munmap((void*) level->data, level->size);
+#else
+    free((void*) level->data);
+#endif
+  }
+  memset(level, 0, sizeof(*level));
+}
@@ -7,6 +7,7 @@
 #include "widget.h"
 
 static Id mainMenuTitle;
+static Id buttons;
 static Id newButton;
 static Id loadButton;
 static Id quitButton;
@@ -16,8 +17,6 @@ static const SDL_Color textColor = {255, 255, 0, 255};
 static const SDL_Color greenTextColor = { 0x22, 0x55, 0, 0xFF };
 
 static Id backgroundTextureId;
-static Id okButtonTextureId;
-static Id backButtonTextureId;
 
 static Id lightScreenSolidTextureId = VOID_ID;
 static Id greenSolidTextureId = VOID_ID;
@@ -34,8 +33,11 @@ static struct {
   Id topBar;
   Id topText;
   Id firstLevelButton;
+  // Widgets, placed with the selector.
   Id okButton;
   Id backButton;
+  SDL_Rect okButtonDest;
+  SDL_Rect backButtonDest;
   struct {
     Id id;
     Id leftBorder;
@@ -57,16 +59,79 @@ void
 centerMainMenu() 
 {
   Graphic_CenterSpriteOnScreenWidth(mainMenuTitle);
-  Graphic_CenterSpriteOnScreenWithOffset(newButton, 0, -20);
-  Graphic_CenterSpriteOnScreenWithOffset(loadButton, 0, 0);
-  Graphic_CenterSpriteOnScreenWithOffset(quitButton, 0, 20);
   // Graphic_ResizeSpriteToScreen(background);
 }
 
+void
+showSelectedButton()
+{
+  int selected = selectedButton;
+  Widget_SetText(newButton, selected == 0 ? ">New" : "New", textColor);
+  Widget_SetText(loadButton, selected == 1 ? ">Load" : "Load", textColor);
+  Widget_SetText(quitButton, selected == 2 ? ">Quit" : "Quit", textColor);
+}
+
+static void
+hideHoveredBorder()
+{
+  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.leftBorder);
+  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.bottomBorder);
+  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.rightBorder);
+  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.topBorder);
+}
+
+void
+setBorderAroundHoveredButton()
+{
+  SDL_Rect rect = levelSelector.hoveredButton.id == levelSelector.okButton
+    ? levelSelector.okButtonDest
+    : levelSelector.backButtonDest;
+  // Widgets are drawn over the border, so it goes around the button.
+  rect.x -= 2;
+  rect.y -= 2;
+  rect.w += 4;
+  rect.h += 4;
+
+  SDL_Rect leftBorderDest;
+  leftBorderDest.x = rect.x;
+  leftBorderDest.y = rect.y;
+  leftBorderDest.w = 2;
+  leftBorderDest.h = rect.h;
+
+  SDL_Rect bottomBorderDest;
+  bottomBorderDest.x = rect.x;
+  bottomBorderDest.y = rect.y + rect.h - 2;
+  bottomBorderDest.w = rect.w;
+  bottomBorderDest.h = 2;
+
+  SDL_Rect rightBorderDest;
+  rightBorderDest.x = rect.x + rect.w - 2;
+  rightBorderDest.y = rect.y;
+  rightBorderDest.w = 2;
+  rightBorderDest.h = rect.h;
+  SDL_Rect topBorderDest;
+  topBorderDest.x = rect.x;
+  topBorderDest.y = rect.y;
+  topBorderDest.w = rect.w;
+  topBorderDest.h = 2;
+
+  Graphic_SetSpriteDest(levelSelector.hoveredButton.leftBorder, leftBorderDest);
+  Graphic_SetSpriteDest(levelSelector.hoveredButton.bottomBorder, bottomBorderDest);
+  Graphic_SetSpriteDest(levelSelector.hoveredButton.rightBorder, rightBorderDest);
+  Graphic_SetSpriteDest(levelSelector.hoveredButton.topBorder, topBorderDest);
+
+  Graphic_SetSpriteToActive(levelSelector.hoveredButton.leftBorder);
+  Graphic_SetSpriteToActive(levelSelector.hoveredButton.bottomBorder);
+  Graphic_SetSpriteToActive(levelSelector.hoveredButton.rightBorder);
+  Graphic_SetSpriteToActive(levelSelector.hoveredButton.topBorder);
+}
+
 void
 openLevelSelector()
 {
   levelSelector.opened = true;
+  // Widgets are drawn over the selector's sprites.
+  Widget_SetHidden(buttons, true);
 
   SDL_Rect backgroundDest;
   backgroundDest.x = 0;
@@ -144,19 +209,38 @@ openLevelSelector()
   Graphic_SetSpriteDest(levelSelector.selectedLevelButton.rightBorder, rightBorderDest);
   Graphic_SetSpriteDest(levelSelector.selectedLevelButton.topBorder, topBarDest);
 
-  SDL_Rect okButton;
-  okButton.x = backgroundDest.x + backgroundDest.w - 80;
-  okButton.y = backgroundDest.y + backgroundDest.h - 30;
-  okButton.w = 40;
-  okButton.h = 25;
-  Graphic_SetSpriteDest(levelSelector.okButton, okButton);
+  SDL_Rect* okButton = &levelSelector.okButtonDest;
+  okButton->x = backgroundDest.x + backgroundDest.w - 80;
+  okButton->y = backgroundDest.y + backgroundDest.h - 30;
+  okButton->w = 40;
+  okButton->h = 25;
+  Widget_SetPosition(
+      levelSelector.okButton, 
+      okButton->x, 
+      okButton->y, 
+      okButton->w, 
+      okButton->h, 
+      0
+  );
 
-  SDL_Rect backButton;
-  backButton.x = backgroundDest.x + backgroundDest.w - 45;
-  backButton.y = backgroundDest.y + backgroundDest.h - 30;
-  backButton.w = 40;
-  backButton.h = 25;
-  Graphic_SetSpriteDest(levelSelector.backButton, backButton);
+  SDL_Rect* backButton = &levelSelector.backButtonDest;
+  backButton->x = backgroundDest.x + backgroundDest.w - 45;
+  backButton->y = backgroundDest.y + backgroundDest.h - 30;
+  backButton->w = 40;
+  backButton->h = 25;
+  Widget_SetPosition(
+      levelSelector.backButton, 
+      backButton->x, 
+      backButton->y, 
+      backButton->w, 
+      backButton->h, 
+      0
+  );
+  Widget_SetHidden(levelSelector.okButton, false);
+  Widget_SetHidden(levelSelector.backButton, false);
+  if (levelSelector.hoveredButton.id != VOID_ID) {
+    setBorderAroundHoveredButton();
+  }
 
   Graphic_SetSpriteToActive(levelSelector.background);
   Graphic_SetSpriteToActive(levelSelector.leftBorder);
@@ -165,8 +249,6 @@ openLevelSelector()
   Graphic_SetSpriteToActive(levelSelector.topBar);
   Graphic_SetSpriteToActive(levelSelector.topText);
   Graphic_SetSpriteToActive(levelSelector.firstLevelButton);
-  Graphic_SetSpriteToActive(levelSelector.okButton);
-  Graphic_SetSpriteToActive(levelSelector.backButton);
   Graphic_SetSpriteToActive(levelSelector.selectedLevelButton.leftBorder);
   Graphic_SetSpriteToActive(levelSelector.selectedLevelButton.bottomBorder);
   Graphic_SetSpriteToActive(levelSelector.selectedLevelButton.rightBorder);
@@ -178,6 +260,10 @@ void
 closeLevelSelector()
 {
   levelSelector.opened = false;
+  levelSelector.hoveredButton.id = VOID_ID;
+  Widget_SetHidden(buttons, false);
+  Widget_SetHidden(levelSelector.okButton, true);
+  Widget_SetHidden(levelSelector.backButton, true);
   Graphic_SetSpriteToInactive(levelSelector.background);
   Graphic_SetSpriteToInactive(levelSelector.leftBorder);
   Graphic_SetSpriteToInactive(levelSelector.bottomBorder);
@@ -185,69 +271,70 @@ closeLevelSelector()
   Graphic_SetSpriteToInactive(levelSelector.topBar);
   Graphic_SetSpriteToInactive(levelSelector.topText);
   Graphic_SetSpriteToInactive(levelSelector.firstLevelButton);
-  Graphic_SetSpriteToInactive(levelSelector.okButton);
-  Graphic_SetSpriteToInactive(levelSelector.backButton);
   Graphic_SetSpriteToInactive(levelSelector.selectedLevelButton.leftBorder);
   Graphic_SetSpriteToInactive(levelSelector.selectedLevelButton.bottomBorder);
   Graphic_SetSpriteToInactive(levelSelector.selectedLevelButton.rightBorder);
   Graphic_SetSpriteToInactive(levelSelector.selectedLevelButton.topBorder);
-  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.leftBorder);
-  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.bottomBorder);
-  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.rightBorder);
-  Graphic_SetSpriteToInactive(levelSelector.hoveredButton.topBorder);
+  hideHoveredBorder();
 }
 
-void
-setBorderAroundHoveredButton()
+static void startGame()
 {
-  SDL_Rect rect;
-  if (levelSelector.hoveredButton.id == levelSelector.okButton) 
-  {
-    Graphic_QuerySpriteDest(levelSelector.okButton, &rect);
-  } 
-  else 
-  {
-    Graphic_QuerySpriteDest(levelSelector.backButton, &rect);
-  }
-
-  SDL_Rect leftBorderDest;
-  leftBorderDest.x = rect.x;
-  leftBorderDest.y = rect.y;
-  leftBorderDest.w = 2;
-  leftBorderDest.h = rect.h;
+  Game_Enter();
+}
 
-  SDL_Rect bottomBorderDest;
-  bottomBorderDest.x = rect.x;
-  bottomBorderDest.y = rect.y + rect.h - 2;
-  bottomBorderDest.w = rect.w;
-  bottomBorderDest.h = 2;
+static void
+onButtonFocus(Id id, Widget_Events e)
+{
+  (void) e;
+  if (Widget_IsFocused(id) && !Scene_IsLoading()) {
+    selectedButton = id == newButton ? 0 : id == loadButton ? 1 : 2;
+    showSelectedButton();
+  }
+}
 
-  SDL_Rect rightBorderDest;
-  rightBorderDest.x = rect.x + rect.w - 2;
-  rightBorderDest.y = rect.y;
-  rightBorderDest.w = 2;
-  rightBorderDest.h = rect.h;
-  SDL_Rect topBorderDest;
-  topBorderDest.x = rect.x;
-  topBorderDest.y = rect.y;
-  topBorderDest.w = rect.w;
-  topBorderDest.h = 2;
+static void
+onButtonClick(Id id, Widget_Events e)
+{
+  (void) e;
+  if (Scene_IsLoading()) {
+    return;
+  }
 
-  Graphic_SetSpriteDest(levelSelector.hoveredButton.leftBorder, leftBorderDest);
-  Graphic_SetSpriteDest(levelSelector.hoveredButton.bottomBorder, bottomBorderDest);
-  Graphic_SetSpriteDest(levelSelector.hoveredButton.rightBorder, rightBorderDest);
-  Graphic_SetSpriteDest(levelSelector.hoveredButton.topBorder, topBorderDest);
+  if (id == newButton) {
+    openLevelSelector();
+  } else if (id == loadButton) {
+    Game_Load(GAME_SAVE_FILE);
+  } else {
+    Scene_Quit();
+  }
+}
 
-  Graphic_SetSpriteToActive(levelSelector.hoveredButton.leftBorder);
-  Graphic_SetSpriteToActive(levelSelector.hoveredButton.bottomBorder);
-  Graphic_SetSpriteToActive(levelSelector.hoveredButton.rightBorder);
-  Graphic_SetSpriteToActive(levelSelector.hoveredButton.topBorder);
+static void
+onSelectorButtonFocus(Id id, Widget_Events e)
+{
+  (void) e;
+  if (Widget_IsFocused(id)) {
+    levelSelector.hoveredButton.id = id;
+    setBorderAroundHoveredButton();
+  } else if (levelSelector.hoveredButton.id == id) {
+    levelSelector.hoveredButton.id = VOID_ID;
+    hideHoveredBorder();
+  }
 }
 
-static void startGame()
+static void
+onSelectorButtonClick(Id id, Widget_Events e)
 {
-  Graphic_Clear();
-  Game_Enter();
+  (void) e;
+  if (Scene_IsLoading()) {
+    return;
+  }
+
+  closeLevelSelector();
+  if (id == levelSelector.okButton) {
+    startGame();
+  }
 }
 
 static void 
@@ -257,64 +344,44 @@ update()
     Scene_Quit();
   }
 
+  if (Input_IsWindowResized()) {
+    centerMainMenu();
+    if (levelSelector.opened) {
+      openLevelSelector();
+    }
+  }
+
+  // The menu keeps running, without taking input, until the game is loaded.
+  if (Scene_IsLoading()) {
+    Game_UpdateSimulation();
+    return;
+  }
+
+  // The mouse is handled by the buttons' listeners.
   if (levelSelector.opened) {
-    SDL_Rect okButtonRect, backButtonRect;
-    Graphic_QuerySpriteDest(levelSelector.okButton, &okButtonRect);
-    Graphic_QuerySpriteDest(levelSelector.backButton, &backButtonRect);
     if (Input_IsKeyReleased(SDLK_ESCAPE)) {
       closeLevelSelector();
-    } else if (Input_IsZoneClicked(okButtonRect, LeftMouseButton) ||
-               Input_IsKeyReleased(SDLK_RETURN)) {
+    } else if (Input_IsKeyReleased(SDLK_RETURN)) {
       closeLevelSelector();
       startGame();
       return;
-    } else if (Input_IsZoneClicked(backButtonRect, LeftMouseButton)) {
-      closeLevelSelector();
-    }
-
-    if (Input_IsMouseOverZone(okButtonRect)) {
-      if (levelSelector.hoveredButton.id != levelSelector.okButton) {
-        levelSelector.hoveredButton.id = levelSelector.okButton;
-        setBorderAroundHoveredButton();
-      }
-    } else if (Input_IsMouseOverZone(backButtonRect)) {
-      if (levelSelector.hoveredButton.id != levelSelector.backButton) {
-        levelSelector.hoveredButton.id = levelSelector.backButton;
-        setBorderAroundHoveredButton();
-      }
-    } 
-    else if (levelSelector.hoveredButton.id != VOID_ID) {
-      levelSelector.hoveredButton.id = VOID_ID;
-      Graphic_SetSpriteToInactive(levelSelector.hoveredButton.leftBorder);
-      Graphic_SetSpriteToInactive(levelSelector.hoveredButton.bottomBorder);
-      Graphic_SetSpriteToInactive(levelSelector.hoveredButton.rightBorder);
-      Graphic_SetSpriteToInactive(levelSelector.hoveredButton.topBorder);
     }
   } else { 
-    SDL_Rect newButtonRect, loadButtonRect, quitButtonRect;
-    Graphic_QuerySpriteDest(newButton, &newButtonRect);
-    Graphic_QuerySpriteDest(loadButton, &loadButtonRect);
-    Graphic_QuerySpriteDest(quitButton, &quitButtonRect);
-
     if (Input_IsKeyReleased(SDLK_RETURN) || 
         Input_IsKeyReleased(SDLK_RETURN2)) {
       switch((int) selectedButton) 
       {
         case 0: openLevelSelector(); break;
-        case 1: break;
+        case 1: 
+          if (Game_Load(GAME_SAVE_FILE)) {
+            return;
+          }
+          break;
         case 2: Scene_Quit(); break;
       }
-    } else if (Input_IsZoneClicked(newButtonRect, LeftMouseButton)) {
-      openLevelSelector();
-    } else if (Input_IsZoneClicked(loadButtonRect, LeftMouseButton)) {
-      // Load
-    } else if (Input_IsZoneClicked(quitButtonRect, LeftMouseButton)) {
-      Scene_Quit();
-      return;
     } else {
       int prev = selectedButton;
       if (Input_IsKeyPressed(SDLK_DOWN)) {
-        prev = selectedButton;
         selectedButton += SELECTION_SPEED;
         if (selectedButton >= 3) {
           selectedButton = 0;
@@ -324,41 +391,45 @@ update()
         if (selectedButton < 0) {
           selectedButton = 2.99;
         }
-      } else if (Input_IsMouseOverZone(newButtonRect)) {
-        selectedButton = 0;
-      } else if (Input_IsMouseOverZone(loadButtonRect)) {
-        selectedButton = 1;
-      } else if (Input_IsMouseOverZone(quitButtonRect)) {
-        selectedButton = 2;
-      } 
-      if (selectedButton != prev) {
-        switch((int) selectedButton) {
-          case 0:
-            Graphic_SetText(newButton, ">New", 0, 0, textColor);
-            Graphic_SetText(loadButton, "Load", 0, 0, textColor);
-            Graphic_SetText(quitButton, "Quit", 0, 0, textColor);
-            break;
-          case 1:
-            Graphic_SetText(newButton, "New", 0, 0, textColor);
-            Graphic_SetText(loadButton, ">Load", 0, 0, textColor);
-            Graphic_SetText(quitButton, "Quit", 0, 0, textColor);
-            break;
-          case 2:
-            Graphic_SetText(newButton, "New", 0, 0, textColor);
-            Graphic_SetText(loadButton, "Load", 0, 0, textColor);
-            Graphic_SetText(quitButton, ">Quit", 0, 0, textColor);
-            break;
-        }
+      }
+      if ((int) selectedButton != prev) {
+        showSelectedButton();
       }
     }
   }
-  centerMainMenu();
   Game_UpdateSimulation();
 }
 
+static void
+hide()
+{
+  Graphic_SetSpriteToInactive(mainMenuTitle);
+  Widget_SetHidden(buttons, true);
+  Widget_SetHidden(levelSelector.okButton, true);
+  Widget_SetHidden(levelSelector.backButton, true);
+  Widget_SetHidden(titleWidget, true);
+}
+
+static void
+show()
+{
+  Graphic_SetSpriteToActive(mainMenuTitle);
+  Widget_SetHidden(buttons, levelSelector.opened);
+  Widget_SetHidden(levelSelector.okButton, !levelSelector.opened);
+  Widget_SetHidden(levelSelector.backButton, !levelSelector.opened);
+  Widget_SetHidden(titleWidget, false);
+  // The game's world went with it.
+  Graphic_InitCamera();
+  Game_StartSimulation();
+  centerMainMenu();
+}
+
+static const Scene scene = { update, hide, show, NULL };
+
 void 
 MainMenu_Enter()
 {
+  Scene_Push(&scene);
   Graphic_InitCamera();
   levelSelector.opened = false; 
   selectedButton = 0;
@@ -378,10 +449,42 @@ MainMenu_Enter()
   src.h = 21;
   Widget_SetSrc(titleWidget, src);
 
+  buttons = Widget_Create(VOID_ID);
+  Widget_SetAligments(
+      buttons, 
+      Widget_HorizontalAlignLeft, 
+      Widget_VerticalAlignCenter
+  );
+  Widget_SetPosition(buttons, 0, 0, 100, 60, UnitInPercentFlags_Width);
+  newButton = Widget_Create(buttons);
+  loadButton = Widget_Create(buttons);
+  quitButton = Widget_Create(buttons);
+  Id menuButtons[] = { newButton, loadButton, quitButton };
+  for (int i = 0; i < 3; i++) {
+    Widget_SetAligments(
+        menuButtons[i], 
+        Widget_HorizontalAlignCenter, 
+        Widget_VerticalAlignTop
+    );
+    Widget_SetPosition(menuButtons[i], 0, i * 20, WIDGET_AUTO, WIDGET_AUTO, 0);
+    Widget_AddEventListener(menuButtons[i], Widget_OnFocus, onButtonFocus);
+    Widget_AddEventListener(menuButtons[i], Widget_OnClick, onButtonClick);
+  }
+  showSelectedButton();
+
+  levelSelector.okButton = Widget_Create(VOID_ID);
+  levelSelector.backButton = Widget_Create(VOID_ID);
+  Widget_SetImage(levelSelector.okButton, "ok.png");
+  Widget_SetImage(levelSelector.backButton, "back.png");
+  Id selectorButtons[] = { levelSelector.okButton, levelSelector.backButton };
+  for (int i = 0; i < 2; i++) {
+    Widget_SetHidden(selectorButtons[i], true);
+    Widget_AddEventListener(selectorButtons[i], Widget_OnFocus, onSelectorButtonFocus);
+    Widget_AddEventListener(selectorButtons[i], Widget_OnClick, onSelectorButtonClick);
+  }
+  levelSelector.hoveredButton.id = VOID_ID;
 
-  backgroundTextureId = Graphic_LoadTexture("background.png");
-  okButtonTextureId = Graphic_LoadTexture("ok.png");
-  backButtonTextureId = Graphic_LoadTexture("back.png");
+  backgroundTextureId = Graphic_LoadTextureAsync("background.png");
   lightScreenSolidTextureId = Graphic_CreateSolidTexture(0xEEFFAA);
   greenSolidTextureId = Graphic_CreateSolidTexture(0x225500);
 
@@ -390,10 +493,8 @@ MainMenu_Enter()
   // Graphic_ResizeSpriteToScreen(background);
 
   // Graphic_CenterSpriteOnScreen(background);
+  Graphic_SetLayer(Graphic_ScreenLayer);
   mainMenuTitle = Graphic_CreateText("Lemonade 5000", 0, 40, textColor);
-  newButton = Graphic_CreateText(">New", 0, 0, textColor);
-  loadButton = Graphic_CreateText("Load", 0, 0, textColor);
-  quitButton = Graphic_CreateText("Quit", 0, 0, textColor);
 
   levelSelector.background = Graphic_CreateInactiveSprite(
     lightScreenSolidTextureId
@@ -430,8 +531,6 @@ MainMenu_Enter()
   levelSelector.selectedLevelButton.topBorder = Graphic_CreateInactiveSprite(
     greenSolidTextureId
   );
-  levelSelector.okButton = Graphic_CreateInactiveSprite(okButtonTextureId);
-  levelSelector.backButton = Graphic_CreateInactiveSprite(backButtonTextureId);
 
   levelSelector.hoveredButton.leftBorder = Graphic_CreateInactiveSprite(
     greenSolidTextureId
@@ -445,9 +544,9 @@ MainMenu_Enter()
   levelSelector.hoveredButton.topBorder = Graphic_CreateInactiveSprite(
     greenSolidTextureId
   );
+  Graphic_SetLayer(Graphic_WorldLayer);
 
   Game_StartSimulation();
 
-  Scene_SetUpdateTo(update);
   centerMainMenu();
 }
@@ -3,26 +3,34 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "arena.h"
 #include "input.h"
 #include "graphic.h"
 #include "scene.h"
 #include "main-menu.h"
+#include "save.h"
 #include "widget.h"
 
+#define ASSET_PACK "assets.pack"
+
 int
 main() 
 {
-  if (!Graphic_Init("Lemonade 5000", 1280, 720, 24)) {
+  if (!Graphic_Init("Lemonade 5000", 1280, 720, 24, Graphic_HardwareBackend)) {
     return(EXIT_FAILURE);
   };
   
+  // Without the pack, images are decoded as they are loaded.
+  Graphic_OpenPack(ASSET_PACK);
   Graphic_InitCamera();
   Widget_Init();
 
   MainMenu_Enter();
   Scene_GameLoop();
+  Save_Wait();
 
   Graphic_Quit();
+  Arena_Quit();
 
   return(EXIT_SUCCESS);
 }
@@ -0,0 +1,168 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define PACK_USE_MMAP
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PACK_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pack.h"
+
+static bool
+_readFile(Pack* pack, const char* filename)
+{
+#ifdef PACK_USE_MMAP
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  pack->data = data;
+  pack->size = info.st_size;
+  return true;
+#else
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL) {
+    return false;
+  }
+
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    size = ftell(file);
+  }
+  unsigned char* data = size > 0 ? malloc(size) : NULL;
+  if (
+      data == NULL ||
+      fseek(file, 0, SEEK_SET) != 0 ||
+      fread(data, 1, size, file) != (size_t) size
+  ) {
+    free(data);
+    fclose(file);
+    return false;
+  }
+  fclose(file);
+
+  pack->data = data;
+  pack->size = size;
+  return true;
+#endif
+}
+
+static bool
+_checkImage(const Pack* pack, const Pack_Image* image)
+{
+  if (!memchr(image->name, '\0', sizeof(image->name))) {
+    return false;
+  }
+  if (image->w == 0 || image->h == 0) {
+    return false;
+  }
+  if (image->pitch / PACK_PIXEL_BYTES < image->w) {
+    return false;
+  }
+  if (image->pixelsOffset % PACK_PAGE || image->pixelsOffset > pack->size) {
+    return false;
+  }
+  return image->h <= (pack->size - image->pixelsOffset) / image->pitch;
+}
+
+static const char*
+_validate(Pack* pack)
+{
+  if (pack->size < sizeof(Pack_Header)) {
+    return "file is too small";
+  }
+
+  const Pack_Header* header = (const Pack_Header*) pack->data;
+  if (memcmp(header->magic, PACK_MAGIC, sizeof(header->magic))) {
+    return "not an asset pack";
+  }
+  if (header->version != PACK_VERSION) {
+    return "unsupported version";
+  }
+  if (
+      header->imagesOffset % 4 ||
+      header->imagesOffset > pack->size ||
+      header->totalImages > 
+        (pack->size - header->imagesOffset) / sizeof(Pack_Image)
+  ) {
+    return "table out of bounds";
+  }
+
+  pack->header = header;
+  pack->images = (const Pack_Image*) (pack->data + header->imagesOffset);
+  for (uint32_t i = 0; i < header->totalImages; i++) {
+    if (!_checkImage(pack, &pack->images[i])) {
+      return "image out of bounds";
+    }
+  }
+
+  return NULL;
+}
+
+bool
+Pack_Open(Pack* pack, const char* filename)
+{
+  memset(pack, 0, sizeof(*pack));
+  if (!_readFile(pack, filename)) {
+    fprintf(stderr, "Asset pack %s could not be read!\n", filename);
+    return false;
+  }
+
+  const char* error = _validate(pack);
+  if (error) {
+    fprintf(stderr, "Asset pack %s is corrupted: %s!\n", filename, error);
+    Pack_Close(pack);
+    return false;
+  }
+
+  return true;
+}
+
+void
+Pack_Close(Pack* pack)
+{
+  if (pack->data) {
+#ifdef PACK_USE_MMAP
+    munmap((void*) pack->data, pack->size);
+#else
+    free((void*) pack->data);
+#endif
+  }
+  memset(pack, 0, sizeof(*pack));
+}
+
+const Pack_Image*
+Pack_Find(const Pack* pack, const char* name)
+{
+  if (pack->header == NULL) {
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < pack->header->totalImages; i++) {
+    if (!strcmp(pack->images[i].name, name)) {
+      return &pack->images[i];
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,275 @@
+#include <string.h>
+
+#include "pool.h"
+
+#define MAX_ELEMENT_SIZE 256
+
+static void*
+_resize(void* data, size_t size)
+{
+  void* resized = realloc(data, size);
+  if (resized == NULL && size) {
+    fprintf(stderr, "Pool couldn't allocate %zu bytes!\n", size);
+    exit(EXIT_FAILURE);
+  }
+  return resized;
+}
+
+static void
+_linkFreeSlots(Pool* pool, Index from, Index to)
+{
+  for (Index slot = from; slot < to; slot++) {
+    pool->indexes[slot] = slot + 1;
+  }
+}
+
+static void
+_grow(Pool* pool)
+{
+  assert(pool->capacity < pool->max);
+
+  Index capacity = pool->capacity * 2;
+  if (capacity > pool->max || capacity < pool->capacity) {
+    capacity = pool->max;
+  }
+
+  pool->indexes = _resize(pool->indexes, capacity * sizeof(Index));
+  pool->ids = _resize(pool->ids, capacity * sizeof(Id));
+  pool->generations = _resize(pool->generations, capacity * sizeof(TinyId));
+  for (int i = 0; i < pool->totalColumns; i++) {
+    *pool->columns[i].data = _resize(
+      *pool->columns[i].data,
+      capacity * pool->columns[i].size
+    );
+  }
+
+  // The old free list ends on the old capacity, the first new slot.
+  _linkFreeSlots(pool, pool->capacity, capacity);
+  memset(
+    pool->generations + pool->capacity,
+    0,
+    (capacity - pool->capacity) * sizeof(TinyId)
+  );
+  pool->capacity = capacity;
+}
+
+static void
+_setIndex(Pool* pool, Index index)
+{
+  pool->indexes[pool->ids[index] & INDEX_INDEX_MASK] = index;
+}
+
+void
+Pool_Init(Pool* pool, Index capacity, Index max)
+{
+  assert(capacity > 0 && capacity <= max && max <= INDEX_INDEX_MASK);
+
+  memset(pool, 0, sizeof(*pool));
+  pool->capacity = capacity;
+  pool->max = max;
+  pool->indexes = _resize(NULL, capacity * sizeof(Index));
+  pool->ids = _resize(NULL, capacity * sizeof(Id));
+  pool->generations = _resize(NULL, capacity * sizeof(TinyId));
+  memset(pool->generations, 0, capacity * sizeof(TinyId));
+  _linkFreeSlots(pool, 0, capacity);
+}
+
+void
+Pool_AddColumn(Pool* pool, void** data, size_t size)
+{
+  assert(pool->totalColumns < POOL_MAX_COLUMNS);
+  assert(size <= MAX_ELEMENT_SIZE);
+
+  *data = _resize(NULL, pool->capacity * size);
+  pool->columns[pool->totalColumns].data = data;
+  pool->columns[pool->totalColumns].size = size;
+  pool->totalColumns++;
+}
+
+void
+Pool_Free(Pool* pool)
+{
+  for (int i = 0; i < pool->totalColumns; i++) {
+    free(*pool->columns[i].data);
+    *pool->columns[i].data = NULL;
+  }
+  free(pool->indexes);
+  free(pool->ids);
+  free(pool->generations);
+  memset(pool, 0, sizeof(*pool));
+}
+
+void
+Pool_Clear(Pool* pool)
+{
+  for (Index i = 0; i < pool->total; i++) {
+    pool->generations[pool->ids[i] & INDEX_INDEX_MASK]++;
+  }
+  pool->total = 0;
+  pool->next_free_index = 0;
+  _linkFreeSlots(pool, 0, pool->capacity);
+}
+
+Id
+Pool_Create(Pool* pool, Index* index)
+{
+  if (pool->next_free_index == pool->capacity) {
+    _grow(pool);
+  }
+
+  Index slot = pool->next_free_index;
+  pool->next_free_index = pool->indexes[slot];
+
+  Index dense = pool->total++;
+  Id id = (Id) pool->generations[slot] << POOL_GENERATION_SHIFT | slot;
+  pool->indexes[slot] = dense;
+  pool->ids[dense] = id;
+
+  if (index) {
+    *index = dense;
+  }
+  return id;
+}
+
+void
+Pool_CreateMany(Pool* pool, Index count, Id* ids)
+{
+  assert(pool->total + count <= pool->max);
+
+  while (pool->capacity - pool->total < count) {
+    _grow(pool);
+  }
+
+  for (Index i = 0; i < count; i++) {
+    ids[i] = Pool_Create(pool, NULL);
+  }
+}
+
+void
+Pool_DeleteAt(Pool* pool, Index index)
+{
+  assert(index < pool->total);
+
+  Index last = --pool->total;
+  Index slot = pool->ids[index] & INDEX_INDEX_MASK;
+  pool->generations[slot]++;
+  pool->indexes[slot] = pool->next_free_index;
+  pool->next_free_index = slot;
+
+  if (index == last) {
+    return;
+  }
+
+  pool->ids[index] = pool->ids[last];
+  _setIndex(pool, index);
+  for (int i = 0; i < pool->totalColumns; i++) {
+    size_t size = pool->columns[i].size;
+    char* data = *pool->columns[i].data;
+    memcpy(data + index * size, data + last * size, size);
+  }
+}
+
+void
+Pool_Delete(Pool* pool, Id id)
+{
+  Pool_DeleteAt(pool, Pool_GetIndex(pool, id));
+}
+
+void
+Pool_DeleteMany(Pool* pool, const Id* ids, Index count)
+{
+  for (Index i = 0; i < count; i++) {
+    Pool_Delete(pool, ids[i]);
+  }
+}
+
+void
+Pool_Swap(Pool* pool, Index a, Index b)
+{
+  assert(a < pool->total && b < pool->total);
+  if (a == b) {
+    return;
+  }
+
+  Id id = pool->ids[a];
+  pool->ids[a] = pool->ids[b];
+  pool->ids[b] = id;
+  _setIndex(pool, a);
+  _setIndex(pool, b);
+
+  char tmp[MAX_ELEMENT_SIZE];
+  for (int i = 0; i < pool->totalColumns; i++) {
+    size_t size = pool->columns[i].size;
+    char* data = *pool->columns[i].data;
+    memcpy(tmp, data + a * size, size);
+    memcpy(data + a * size, data + b * size, size);
+    memcpy(data + b * size, tmp, size);
+  }
+}
+
+void
+Pool_Move(Pool* pool, Index from, Index to)
+{
+  assert(from < pool->total && to < pool->total);
+  if (from == to) {
+    return;
+  }
+
+  Index low = from < to ? from : to;
+  Index high = from < to ? to : from;
+  Index count = high - low;
+  char tmp[MAX_ELEMENT_SIZE];
+
+  for (int i = 0; i < pool->totalColumns; i++) {
+    size_t size = pool->columns[i].size;
+    char* data = *pool->columns[i].data;
+    memcpy(tmp, data + from * size, size);
+    if (from < to) {
+      memmove(data + from * size, data + (from + 1) * size, count * size);
+    } else {
+      memmove(data + (to + 1) * size, data + to * size, count * size);
+    }
+    memcpy(data + to * size, tmp, size);
+  }
+
+  Id id = pool->ids[from];
+  if (from < to) {
+    memmove(&pool->ids[from], &pool->ids[from + 1], count * sizeof(Id));
+  } else {
+    memmove(&pool->ids[to + 1], &pool->ids[to], count * sizeof(Id));
+  }
+  pool->ids[to] = id;
+
+  for (Index i = low; i <= high; i++) {
+    _setIndex(pool, i);
+  }
+}
+
+bool
+Pool_Check(const Pool* pool)
+{
+  if (pool->total > pool->capacity || pool->capacity > pool->max) {
+    return false;
+  }
+
+  for (Index i = 0; i < pool->total; i++) {
+    Id id = pool->ids[i];
+    Index slot = id & INDEX_INDEX_MASK;
+    if (slot >= pool->capacity ||
+        pool->indexes[slot] != i ||
+        pool->generations[slot] != id >> POOL_GENERATION_SHIFT) {
+      return false;
+    }
+  }
+
+  Index free = 0;
+  for (Index slot = pool->next_free_index;
+       slot < pool->capacity;
+       slot = pool->indexes[slot]) {
+    if (++free > pool->capacity) {
+      return false;
+    }
+  }
+
+  return free == pool->capacity - pool->total;
+}
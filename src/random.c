@@ -0,0 +1,115 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "random.h"
+
+#define MULTIPLIER 6364136223846793005ULL
+#define DOUBLE_UNIT (1.0 / 9007199254740992.0)
+
+static _Thread_local Random_State _default;
+static _Thread_local bool _defaultSeeded;
+
+static inline uint32_t
+_next(Random_State* random)
+{
+  uint64_t old = random->state;
+  random->state = old * MULTIPLIER + random->increment;
+
+  uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+  uint32_t rotation = old >> 59;
+  return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+// Lemire's multiply-shift, rejecting the few values that would bias it.
+static inline uint32_t
+_range(Random_State* random, uint32_t bound)
+{
+  uint64_t m = (uint64_t) _next(random) * bound;
+  uint32_t low = (uint32_t) m;
+  if (low < bound) {
+    uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      m = (uint64_t) _next(random) * bound;
+      low = (uint32_t) m;
+    }
+  }
+  return m >> 32;
+}
+
+static inline double
+_double(Random_State* random)
+{
+  uint64_t high = _next(random) >> 5;
+  uint64_t low = _next(random) >> 6;
+  return ((high << 26) | low) * DOUBLE_UNIT;
+}
+
+void
+Random_Seed(Random_State* random, uint64_t seed, uint64_t stream)
+{
+  random->state = 0;
+  random->increment = (stream << 1) | 1;
+  _next(random);
+  random->state += seed;
+  _next(random);
+}
+
+Random_State*
+Random_Default()
+{
+  if (!_defaultSeeded) {
+    // The state's address gives each thread its own stream.
+    Random_Seed(&_default, time(NULL), (uintptr_t) &_default);
+    _defaultSeeded = true;
+  }
+  return &_default;
+}
+
+uint32_t
+Random_Next(Random_State* random)
+{
+  return _next(random);
+}
+
+uint32_t
+Random_Range(Random_State* random, uint32_t bound)
+{
+  assert(bound > 0);
+  return _range(random, bound);
+}
+
+double
+Random_NextDouble(Random_State* random)
+{
+  return _double(random);
+}
+
+void
+Random_Fill(Random_State* random, uint32_t* values, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    values[i] = _next(random);
+  }
+}
+
+void
+Random_FillRange(
+  Random_State* random,
+  uint32_t* values,
+  size_t count,
+  uint32_t bound
+) {
+  assert(bound > 0);
+  for (size_t i = 0; i < count; i++) {
+    values[i] = _range(random, bound);
+  }
+}
+
+void
+Random_FillDouble(Random_State* random, double* values, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    values[i] = _double(random);
+  }
+}
@@ -0,0 +1,433 @@
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "save.h"
+
+#define OBJECT_BYTES (6 * sizeof(double) + 3 * sizeof(uint32_t))
+#define CELLS_BYTES (LEVEL_CHUNK_CELLS * sizeof(uint16_t))
+
+typedef struct {
+  Save_State* state;
+  char* filename;
+} _Job;
+
+static SDL_Thread* _writer = NULL;
+
+static void*
+_allocate(size_t size)
+{
+  void* data = malloc(size);
+  if (data == NULL) {
+    fprintf(stderr, "Save couldn't allocate %zu bytes!\n", size);
+    exit(EXIT_FAILURE);
+  }
+  return data;
+}
+
+static size_t
+_align(size_t offset, size_t alignment)
+{
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+Save_State*
+Save_CreateState(
+    uint32_t totalObjects, 
+    uint32_t totalPrefabs, 
+    uint32_t totalPrefabObjects, 
+    uint32_t totalChunks
+)
+{
+  // One block: the state, its object arrays, its prefabs, then its chunks.
+  size_t objectsBytes = (size_t) totalObjects * OBJECT_BYTES;
+  size_t prefabsOffset = _align(sizeof(Save_State) + objectsBytes, 4);
+  size_t prefabObjectsOffset = 
+    prefabsOffset + (size_t) totalPrefabs * sizeof(Level_Prefab);
+  size_t chunksOffset = _align(
+      prefabObjectsOffset + (size_t) totalPrefabObjects * sizeof(Level_Object),
+      8
+  );
+  unsigned char* data = _allocate(
+      chunksOffset + (size_t) totalChunks * sizeof(Save_Chunk)
+  );
+
+  Save_State* state = (Save_State*) data;
+  memset(state, 0, sizeof(*state));
+  state->totalObjects = totalObjects;
+  state->totalPrefabs = totalPrefabs;
+  state->totalPrefabObjects = totalPrefabObjects;
+  state->totalChunks = totalChunks;
+
+  double* doubles = (double*) (data + sizeof(Save_State));
+  state->x = doubles;
+  state->y = doubles + totalObjects;
+  state->z = doubles + 2 * totalObjects;
+  state->dx = doubles + 3 * totalObjects;
+  state->dy = doubles + 4 * totalObjects;
+  state->dz = doubles + 5 * totalObjects;
+  state->tiles = (uint32_t*) (doubles + 6 * totalObjects);
+  state->paths = state->tiles + totalObjects;
+  state->slices = (int32_t*) (state->paths + totalObjects);
+  state->prefabs = (Level_Prefab*) (data + prefabsOffset);
+  state->prefabObjects = (Level_Object*) (data + prefabObjectsOffset);
+  state->chunks = (Save_Chunk*) (data + chunksOffset);
+  return state;
+}
+
+void
+Save_FreeState(Save_State* state)
+{
+  free(state);
+}
+
+static uint32_t
+_countCells(const Save_State* state)
+{
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < state->totalChunks; i++) {
+    total += state->chunks[i].hasGround + state->chunks[i].hasObjects;
+  }
+  return total;
+}
+
+static uint32_t
+_packCells(unsigned char* data, uint32_t offset, const unsigned int* cells)
+{
+  uint16_t* packed = (uint16_t*) (data + offset);
+  for (int i = 0; i < LEVEL_CHUNK_CELLS; i++) {
+    packed[i] = cells[i];
+  }
+  return offset;
+}
+
+/* Packs the state into the file format, in a buffer of *size bytes. */
+static unsigned char*
+_serialize(const Save_State* state, size_t* size)
+{
+  uint32_t n = state->totalObjects;
+  size_t objectsOffset = sizeof(Save_Header);
+  size_t prefabsOffset = _align(objectsOffset + (size_t) n * OBJECT_BYTES, 4);
+  size_t prefabObjectsOffset = 
+    prefabsOffset + state->totalPrefabs * sizeof(Level_Prefab);
+  size_t chunksOffset = 
+    prefabObjectsOffset + state->totalPrefabObjects * sizeof(Level_Object);
+  size_t cellsOffset = chunksOffset + state->totalChunks * sizeof(Level_Chunk);
+  *size = cellsOffset + _countCells(state) * CELLS_BYTES;
+
+  unsigned char* data = _allocate(*size);
+  Save_Header* header = (Save_Header*) data;
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, SAVE_MAGIC, sizeof(header->magic));
+  header->version = SAVE_VERSION;
+  header->width = state->width;
+  header->height = state->height;
+  memcpy(header->lanes, state->lanes, sizeof(header->lanes));
+  header->randomState = state->random.state;
+  header->randomIncrement = state->random.increment;
+  header->totalObjects = n;
+  header->objectsOffset = objectsOffset;
+  header->totalPrefabs = state->totalPrefabs;
+  header->prefabsOffset = prefabsOffset;
+  header->totalPrefabObjects = state->totalPrefabObjects;
+  header->prefabObjectsOffset = prefabObjectsOffset;
+  header->totalChunks = state->totalChunks;
+  header->chunksOffset = chunksOffset;
+
+  // The state's arrays are already laid out as in the file.
+  memcpy(data + objectsOffset, state->x, (size_t) n * OBJECT_BYTES);
+  memcpy(
+      data + prefabsOffset, 
+      state->prefabs, 
+      state->totalPrefabs * sizeof(Level_Prefab)
+  );
+  memcpy(
+      data + prefabObjectsOffset, 
+      state->prefabObjects, 
+      state->totalPrefabObjects * sizeof(Level_Object)
+  );
+
+  Level_Chunk* chunks = (Level_Chunk*) (data + chunksOffset);
+  uint32_t offset = cellsOffset;
+  for (uint32_t i = 0; i < state->totalChunks; i++) {
+    const Save_Chunk* chunk = &state->chunks[i];
+    chunks[i].x = chunk->x;
+    chunks[i].y = chunk->y;
+    chunks[i].groundOffset = 0;
+    chunks[i].objectOffset = 0;
+    if (chunk->hasGround) {
+      chunks[i].groundOffset = _packCells(data, offset, chunk->ground);
+      offset += CELLS_BYTES;
+    }
+    if (chunk->hasObjects) {
+      chunks[i].objectOffset = _packCells(data, offset, chunk->objects);
+      offset += CELLS_BYTES;
+    }
+  }
+
+  return data;
+}
+
+static int
+_write(void* data)
+{
+  _Job* job = data;
+  size_t size;
+  unsigned char* buffer = _serialize(job->state, &size);
+  Save_FreeState(job->state);
+
+  size_t length = strlen(job->filename);
+  char* temporary = _allocate(length + sizeof(".tmp"));
+  memcpy(temporary, job->filename, length);
+  memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+  FILE* file = fopen(temporary, "wb");
+  bool written = file && fwrite(buffer, 1, size, file) == size;
+  if (file && fclose(file) != 0) {
+    written = false;
+  }
+  if (!written || rename(temporary, job->filename) != 0) {
+    fprintf(stderr, "Save %s could not be written!\n", job->filename);
+    remove(temporary);
+  }
+
+  free(temporary);
+  free(buffer);
+  free(job->filename);
+  free(job);
+  return 0;
+}
+
+void
+Save_WriteAsync(Save_State* state, const char* filename)
+{
+  Save_Wait();
+
+  _Job* job = _allocate(sizeof(*job));
+  size_t length = strlen(filename) + 1;
+  job->state = state;
+  job->filename = _allocate(length);
+  memcpy(job->filename, filename, length);
+
+  _writer = SDL_CreateThread(_write, "save", job);
+  if (_writer == NULL) {
+    fprintf(stderr, "Save thread could not start! SDL_Error: %s\n", SDL_GetError());
+    _write(job);
+  }
+}
+
+void
+Save_Wait()
+{
+  if (_writer) {
+    SDL_WaitThread(_writer, NULL);
+    _writer = NULL;
+  }
+}
+
+static const void*
+_getTable(
+    const Save_File* file, 
+    size_t offset, 
+    size_t count, 
+    size_t size, 
+    size_t alignment
+)
+{
+  if (offset % alignment || offset > file->size) {
+    return NULL;
+  }
+  if (count > (file->size - offset) / size) {
+    return NULL;
+  }
+  return file->data + offset;
+}
+
+const uint16_t*
+Save_GetCells(const Save_File* file, uint32_t offset)
+{
+  return offset ? (const uint16_t*) (file->data + offset) : NULL;
+}
+
+static bool
+_checkCells(const Save_File* file, uint32_t offset)
+{
+  if (offset == 0) {
+    return true;
+  }
+  if (offset % 2 || offset > file->size || file->size - offset < CELLS_BYTES) {
+    return false;
+  }
+
+  const uint16_t* cells = Save_GetCells(file, offset);
+  for (int i = 0; i < LEVEL_CHUNK_CELLS; i++) {
+    if (cells[i] >= TotalGameTiles) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static const char*
+_validate(Save_File* file)
+{
+  if (file->size < sizeof(Save_Header)) {
+    return "file is too small";
+  }
+
+  const Save_Header* header = (const Save_Header*) file->data;
+  if (memcmp(header->magic, SAVE_MAGIC, sizeof(header->magic))) {
+    return "not a save file";
+  }
+  if (header->version != SAVE_VERSION) {
+    return "unsupported version";
+  }
+  if (
+      header->width == 0 ||
+      header->height == 0 ||
+      header->width > 0xFFFF * LEVEL_CHUNK_SIZE ||
+      header->height > 0xFFFF * LEVEL_CHUNK_SIZE
+  ) {
+    return "invalid map size";
+  }
+
+  uint32_t n = header->totalObjects;
+  const unsigned char* objects = _getTable(
+      file,
+      header->objectsOffset,
+      n,
+      OBJECT_BYTES,
+      sizeof(double)
+  );
+  file->prefabs = _getTable(
+      file,
+      header->prefabsOffset,
+      header->totalPrefabs,
+      sizeof(*file->prefabs),
+      sizeof(uint32_t)
+  );
+  file->prefabObjects = _getTable(
+      file,
+      header->prefabObjectsOffset,
+      header->totalPrefabObjects,
+      sizeof(*file->prefabObjects),
+      sizeof(uint32_t)
+  );
+  file->chunks = _getTable(
+      file,
+      header->chunksOffset,
+      header->totalChunks,
+      sizeof(*file->chunks),
+      sizeof(uint32_t)
+  );
+  if (
+      objects == NULL || 
+      file->prefabs == NULL || 
+      file->prefabObjects == NULL || 
+      file->chunks == NULL
+  ) {
+    return "table out of bounds";
+  }
+
+  file->header = header;
+  file->x = (const double*) objects;
+  file->y = file->x + n;
+  file->z = file->x + 2 * n;
+  file->dx = file->x + 3 * n;
+  file->dy = file->x + 4 * n;
+  file->dz = file->x + 5 * n;
+  file->tiles = (const uint32_t*) (file->x + 6 * n);
+  file->paths = file->tiles + n;
+  file->slices = (const int32_t*) (file->paths + n);
+
+  for (uint32_t i = 0; i < n; i++) {
+    if (
+        file->tiles[i] >= TotalGameTiles || 
+        file->paths[i] >= TotalPaths ||
+        file->slices[i] < -1
+    ) {
+      return "invalid object";
+    }
+  }
+
+  for (uint32_t i = 0; i < header->totalPrefabObjects; i++) {
+    if (file->prefabObjects[i].tile >= TotalGameTiles) {
+      return "invalid prefab object";
+    }
+  }
+  for (uint32_t i = 0; i < header->totalPrefabs; i++) {
+    const Level_Prefab* prefab = &file->prefabs[i];
+    if (
+        prefab->firstObject > header->totalPrefabObjects ||
+        prefab->totalObjects > header->totalPrefabObjects - prefab->firstObject
+    ) {
+      return "prefab objects out of bounds";
+    }
+  }
+
+  uint32_t chunksWide = (header->width + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+  uint32_t chunksHigh = (header->height + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+  for (uint32_t i = 0; i < header->totalChunks; i++) {
+    const Level_Chunk* chunk = &file->chunks[i];
+    if (chunk->x >= chunksWide || chunk->y >= chunksHigh) {
+      return "chunk out of the map";
+    }
+    if (
+        !_checkCells(file, chunk->groundOffset) ||
+        !_checkCells(file, chunk->objectOffset)
+    ) {
+      return "invalid chunk cells";
+    }
+  }
+
+  return NULL;
+}
+
+bool
+Save_Open(Save_File* file, const char* filename)
+{
+  memset(file, 0, sizeof(*file));
+
+  // A save still being written would be read half done.
+  Save_Wait();
+
+  FILE* input = fopen(filename, "rb");
+  if (input == NULL) {
+    fprintf(stderr, "Save %s could not be opened!\n", filename);
+    return false;
+  }
+
+  long size = -1;
+  if (fseek(input, 0, SEEK_END) == 0) {
+    size = ftell(input);
+  }
+  file->data = size > 0 ? malloc(size) : NULL;
+  file->size = size;
+  if (
+      file->data == NULL ||
+      fseek(input, 0, SEEK_SET) != 0 ||
+      fread(file->data, 1, size, input) != (size_t) size
+  ) {
+    fprintf(stderr, "Save %s could not be read!\n", filename);
+    fclose(input);
+    Save_Close(file);
+    return false;
+  }
+  fclose(input);
+
+  const char* error = _validate(file);
+  if (error) {
+    fprintf(stderr, "Save %s is corrupted: %s!\n", filename, error);
+    Save_Close(file);
+    return false;
+  }
+  return true;
+}
+
+void
+Save_Close(Save_File* file)
+{
+  free(file->data);
+  memset(file, 0, sizeof(*file));
+}
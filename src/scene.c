@@ -1,16 +1,52 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "scene.h"
 #include "graphic.h"
 #include "input.h"
-#include "gui.h"
-
-static UpdateFunc update;
-static bool running = true;
+#include "widget.h"
 
 #define MS_PER_UPDATE 8
 #define MS_PER_FRAME 16
+#define MAX_SCENES 8
+
+static struct {
+  const Scene* scenes[MAX_SCENES];
+  int total;
+} _stack;
+static bool running = true;
+
+/* done is set by the worker once result is written. */
+static struct {
+  SDL_Thread* thread;
+  Scene_LoadFunc load;
+  Scene_ReadyFunc ready;
+  void* data;
+  bool result;
+  SDL_atomic_t done;
+  bool loading;
+} _loader;
+
+static int
+_runLoad(void* data)
+{
+  (void) data;
+  _loader.result = _loader.load(_loader.data);
+  SDL_AtomicSet(&_loader.done, 1);
+  return 0;
+}
+
+static void
+_finishLoad(bool quitting)
+{
+  if (_loader.thread) {
+    SDL_WaitThread(_loader.thread, NULL);
+    _loader.thread = NULL;
+  }
+  _loader.loading = false;
+  _loader.ready(_loader.data, _loader.result && !quitting);
+}
 
 void 
 Scene_GameLoop()
@@ -21,13 +57,19 @@ Scene_GameLoop()
     current = SDL_GetTicks();
     Uint32 elapsed = current - previous;
     previous = current;
+    Arena_Reset(Arena_GetFrame());
+
+    if (_loader.loading && SDL_AtomicGet(&_loader.done)) {
+      _finishLoad(false);
+    }
 
     updateLag += elapsed;
 
     int runs = 0;
     while (updateLag >= MS_PER_UPDATE && runs < 5) {
       Input_PollInputs();
-      update();
+      Widget_HandleEvents();
+      _stack.scenes[_stack.total - 1]->update();
 
       runs++;
       updateLag -= MS_PER_UPDATE;
@@ -36,12 +78,79 @@ Scene_GameLoop()
     Graphic_Render();
     SDL_Delay(1);
   }
+
+  if (_loader.loading) {
+    _finishLoad(true);
+  }
 }
 
-void 
-Scene_SetUpdateTo(UpdateFunc func)
+void
+Scene_Push(const Scene* scene)
+{
+  assert(_stack.total < MAX_SCENES);
+  if (_stack.total && _stack.scenes[_stack.total - 1]->hide) {
+    _stack.scenes[_stack.total - 1]->hide();
+  }
+  _stack.scenes[_stack.total++] = scene;
+  Graphic_OpenScope();
+  Widget_OpenScope();
+}
+
+void
+Scene_Pop()
 {
-  update = func;
+  assert(_stack.total > 1);
+  const Scene* scene = _stack.scenes[--_stack.total];
+  if (scene->exit) {
+    scene->exit();
+  }
+  Widget_CloseScope();
+  Graphic_CloseScope();
+  if (_stack.scenes[_stack.total - 1]->show) {
+    _stack.scenes[_stack.total - 1]->show();
+  }
+}
+
+const Scene*
+Scene_GetCurrent()
+{
+  return _stack.total ? _stack.scenes[_stack.total - 1] : NULL;
+}
+
+bool
+Scene_LoadInBackground(Scene_LoadFunc load, Scene_ReadyFunc ready, void* data)
+{
+  if (_loader.loading) {
+    return false;
+  }
+
+  _loader.load = load;
+  _loader.ready = ready;
+  _loader.data = data;
+  _loader.result = false;
+  _loader.loading = true;
+  SDL_AtomicSet(&_loader.done, 0);
+  _loader.thread = SDL_CreateThread(_runLoad, "scene loader", NULL);
+  if (_loader.thread == NULL) {
+    // Loading in place only stalls the current scene.
+    fprintf(stderr, "Loader thread could not start! SDL_Error: %s\n", SDL_GetError());
+    _runLoad(NULL);
+  }
+  return true;
+}
+
+bool
+Scene_IsLoading()
+{
+  return _loader.loading;
+}
+
+void
+Scene_FinishLoading()
+{
+  if (_loader.loading) {
+    _finishLoad(false);
+  }
 }
 
 void
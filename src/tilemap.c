@@ -0,0 +1,192 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tilemap.h"
+
+#define FREE_SLOT 0xFFFFFFFFu
+#define INITIAL_CAPACITY 64
+#define CHUNK_CELLS (TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE)
+
+static void*
+_allocate(size_t size)
+{
+  void* data = malloc(size);
+  if (data == NULL) {
+    fprintf(stderr, "Tilemap couldn't allocate %zu bytes!\n", size);
+    exit(EXIT_FAILURE);
+  }
+  return data;
+}
+
+static inline unsigned int
+_getKey(int cx, int cy)
+{
+  return (unsigned int) cy << 16 | (unsigned int) cx;
+}
+
+// Fibonacci hashing: the high bits of the product are the well mixed ones.
+static inline unsigned int
+_getSlot(const Tilemap* map, unsigned int key)
+{
+  return (key * 2654435769u) >> map->shift;
+}
+
+static Tilemap_Slot*
+_findSlot(const Tilemap* map, unsigned int key)
+{
+  unsigned int mask = map->capacity - 1;
+  for (unsigned int i = _getSlot(map, key); ; i = (i + 1) & mask) {
+    Tilemap_Slot* slot = &map->slots[i];
+    if (slot->key == key || slot->key == FREE_SLOT) {
+      return slot;
+    }
+  }
+}
+
+static void
+_allocateSlots(Tilemap* map, unsigned int capacity)
+{
+  map->capacity = capacity;
+  map->shift = 32;
+  while (capacity > 1) {
+    capacity >>= 1;
+    map->shift--;
+  }
+
+  map->slots = _allocate(map->capacity * sizeof(Tilemap_Slot));
+  for (unsigned int i = 0; i < map->capacity; i++) {
+    map->slots[i].key = FREE_SLOT;
+    map->slots[i].cells = NULL;
+  }
+}
+
+static void
+_grow(Tilemap* map)
+{
+  Tilemap_Slot* slots = map->slots;
+  unsigned int capacity = map->capacity;
+
+  _allocateSlots(map, capacity * 2);
+  for (unsigned int i = 0; i < capacity; i++) {
+    if (slots[i].key != FREE_SLOT) {
+      *_findSlot(map, slots[i].key) = slots[i];
+    }
+  }
+  free(slots);
+}
+
+void
+Tilemap_Init(Tilemap* map, int width, int height, unsigned int empty)
+{
+  assert(width > 0 && width <= TILEMAP_MAX_SIZE);
+  assert(height > 0 && height <= TILEMAP_MAX_SIZE);
+
+  map->width = width;
+  map->height = height;
+  map->empty = empty;
+  map->totalChunks = 0;
+  _allocateSlots(map, INITIAL_CAPACITY);
+}
+
+void
+Tilemap_Clear(Tilemap* map)
+{
+  for (unsigned int i = 0; i < map->capacity; i++) {
+    free(map->slots[i].cells);
+    map->slots[i].key = FREE_SLOT;
+    map->slots[i].cells = NULL;
+  }
+  map->totalChunks = 0;
+}
+
+void
+Tilemap_Free(Tilemap* map)
+{
+  Tilemap_Clear(map);
+  free(map->slots);
+  memset(map, 0, sizeof(*map));
+}
+
+const unsigned int*
+Tilemap_QueryChunk(const Tilemap* map, int cx, int cy)
+{
+  return _findSlot(map, _getKey(cx, cy))->cells;
+}
+
+unsigned int
+Tilemap_Get(const Tilemap* map, int x, int y)
+{
+  assert(x >= 0 && x < map->width && y >= 0 && y < map->height);
+
+  const unsigned int* cells = Tilemap_QueryChunk(
+    map, 
+    x >> TILEMAP_CHUNK_SHIFT, 
+    y >> TILEMAP_CHUNK_SHIFT
+  );
+  if (cells == NULL) {
+    return map->empty;
+  }
+  return cells[(y & TILEMAP_CHUNK_MASK) << TILEMAP_CHUNK_SHIFT | 
+               (x & TILEMAP_CHUNK_MASK)];
+}
+
+bool
+Tilemap_Has(const Tilemap* map, int x, int y)
+{
+  return Tilemap_Get(map, x, y) != map->empty;
+}
+
+void
+Tilemap_Set(Tilemap* map, int x, int y, unsigned int value)
+{
+  assert(x >= 0 && x < map->width && y >= 0 && y < map->height);
+
+  int cx = x >> TILEMAP_CHUNK_SHIFT;
+  int cy = y >> TILEMAP_CHUNK_SHIFT;
+  unsigned int* cells = _findSlot(map, _getKey(cx, cy))->cells;
+  if (cells == NULL) {
+    if (value == map->empty) {
+      return;
+    }
+    cells = Tilemap_AcquireChunk(map, cx, cy);
+  }
+
+  cells[(y & TILEMAP_CHUNK_MASK) << TILEMAP_CHUNK_SHIFT | 
+        (x & TILEMAP_CHUNK_MASK)] = value;
+}
+
+unsigned int*
+Tilemap_AcquireChunk(Tilemap* map, int cx, int cy)
+{
+  assert(cx >= 0 && cx << TILEMAP_CHUNK_SHIFT < map->width);
+  assert(cy >= 0 && cy << TILEMAP_CHUNK_SHIFT < map->height);
+
+  unsigned int key = _getKey(cx, cy);
+  Tilemap_Slot* slot = _findSlot(map, key);
+  if (slot->cells != NULL) {
+    return slot->cells;
+  }
+
+  // Keep the table at most 3/4 full so probes stay short.
+  if ((map->totalChunks + 1) * 4 > map->capacity * 3) {
+    _grow(map);
+    slot = _findSlot(map, key);
+  }
+
+  slot->key = key;
+  slot->cells = _allocate(CHUNK_CELLS * sizeof(unsigned int));
+  for (int i = 0; i < CHUNK_CELLS; i++) {
+    slot->cells[i] = map->empty;
+  }
+  map->totalChunks++;
+  return slot->cells;
+}
+
+size_t
+Tilemap_QueryMemory(const Tilemap* map)
+{
+  return map->capacity * sizeof(Tilemap_Slot) + 
+    map->totalChunks * CHUNK_CELLS * sizeof(unsigned int);
+}
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tileset.h"
+
+#define MAX_LINE 256
+#define MAX_NAME 64
+
+static const char* const _tileNames[] = { GAME_TILES(GAME_TYPES_NAME) };
+
+static int
+_findTile(const char* name)
+{
+  for (int i = 0; i < TotalGameTiles; i++) {
+    if (!strcmp(_tileNames[i], name)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Parses the options after a tile's rect, or returns what is wrong. */
+static const char*
+_parseOptions(Tileset_Tile* tile, const char* options)
+{
+  char option[MAX_NAME];
+  int length;
+  while (sscanf(options, "%63s%n", option, &length) == 1) {
+    options += length;
+    if (!strcmp(option, "anchor")) {
+      if (sscanf(options, "%d %d%n", &tile->anchor.x, &tile->anchor.y, &length) != 2) {
+        return "expected: anchor X Y";
+      }
+    } else if (!strcmp(option, "next")) {
+      char name[MAX_NAME];
+      int next;
+      if (
+          sscanf(options, "%63s%n", name, &length) != 1 ||
+          (next = _findTile(name)) <= GameTile_Empty
+      ) {
+        return "expected: next TILE";
+      }
+      tile->next = next;
+    } else {
+      return "unknown option";
+    }
+    options += length;
+  }
+  return NULL;
+}
+
+static const char*
+_parseTile(
+    Tileset_Tile tiles[TotalGameTiles], 
+    bool defined[TotalGameTiles],
+    const char* line, 
+    int tileHeight
+)
+{
+  char name[MAX_NAME];
+  SDL_Rect src;
+  int length;
+  if (
+      sscanf(line, "%63s %d %d %d %d%n", name, &src.x, &src.y, &src.w, &src.h, &length) 
+      != 5
+  ) {
+    return "expected: TILE X Y W H";
+  }
+
+  int tile = _findTile(name);
+  if (tile <= GameTile_Empty) {
+    return "unknown tile";
+  }
+  if (defined[tile]) {
+    return "tile defined twice";
+  }
+  if (src.x < 0 || src.y < 0 || src.w <= 0 || src.h <= 0) {
+    return "invalid rect";
+  }
+
+  tiles[tile].src = src;
+  tiles[tile].anchor.x = 0;
+  tiles[tile].anchor.y = src.h - tileHeight;
+  tiles[tile].next = tile;
+  defined[tile] = true;
+  return _parseOptions(&tiles[tile], line + length);
+}
+
+bool
+Tileset_Load(
+    Tileset_Tile tiles[TotalGameTiles], 
+    const char* filename, 
+    int tileHeight
+)
+{
+  FILE* file = fopen(filename, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Tileset %s could not be opened!\n", filename);
+    return false;
+  }
+
+  bool defined[TotalGameTiles] = { false };
+  memset(&tiles[GameTile_Empty], 0, sizeof(tiles[GameTile_Empty]));
+  defined[GameTile_Empty] = true;
+
+  char line[MAX_LINE];
+  const char* error = NULL;
+  int number;
+  for (number = 1; !error && fgets(line, sizeof(line), file); number++) {
+    line[strcspn(line, "#\r\n")] = '\0';
+    if (strspn(line, " \t") != strlen(line)) {
+      error = _parseTile(tiles, defined, line, tileHeight);
+    }
+  }
+  fclose(file);
+
+  if (error) {
+    fprintf(stderr, "%s:%d: %s!\n", filename, number - 1, error);
+    return false;
+  }
+  for (int i = 0; i < TotalGameTiles; i++) {
+    if (!defined[i]) {
+      fprintf(stderr, "Tileset %s is missing %s!\n", filename, _tileNames[i]);
+      return false;
+    }
+  }
+  return true;
+}
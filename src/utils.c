@@ -1,19 +1,9 @@
-#include <stdlib.h>
-#include <time.h>
-#include <stdbool.h>
-
-static bool initiated;
+#include "random.h"
+#include "utils.h"
 
 
 double
 utils_random()
 {
-    if(!initiated) {
-        srand(time(NULL));
-        initiated = !initiated;
-    }
-
-    double r = (double) rand() / (double) rand();
-
-    return r - (int) r;
+    return Random_NextDouble(Random_Default());
 }
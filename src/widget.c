@@ -1,134 +1,497 @@
+#include <string.h>
+
 #include "widget.h"
 #include "graphic.h"
+#include "input.h"
+#include "pool.h"
 
 #define MAX_Widget_ELEMENTS 1000
-
-#define AUTO -1
+#define INITIAL_Widget_ELEMENTS 64
+#define HIT_CELL_SIZE 32
 
 typedef struct {
   double w, h, x, y;
   Widget_HorizontalAlignment horizontalAlignment;
   Widget_VerticalAlignment verticalAlignment;
   UnitInPercentFlags unitInPercentFlags;
-  Index  parent;
+  Id parent;
+  Index subtreeSize;
   Uint32 backgroundColor;
   Uint32 bordersColor;
   SDL_Texture* texture;
   SDL_Rect dest;
   SDL_Rect src;
+  Widget_OnHandlerFunc handlers[Widget_All];
+  bool hidden;
+  bool relayout;
+  int scope;
 } Element;
 
 
+/*
+ * Widgets are kept in pre-order: a widget comes right before its subtree,
+ * which is subtreeSize long counting itself, so parents are laid out before
+ * their children in one pass and a hidden subtree is skipped at once.
+ * Widgets belong to the scope open when they were created.
+ *
+ * Widgets marked for relayout are laid out again with their subtree, and
+ * drawn into target with all the others, only when dirty. Otherwise each
+ * frame copies target as is.
+ */
 static struct {
-  Element elements[MAX_Widget_ELEMENTS];
-  SET_STRUCT_FOR_DOD(Id, MAX_Widget_ELEMENTS);
+  Element* elements;
+  int scope;
+  int layoutWidth, layoutHeight;
+  SDL_Texture* target;
+  int targetWidth, targetHeight;
+  int totalDrawn;
+  bool dirty;
+  Id focused;
+  Pool pool;
 } _elements;
 
+/*
+ * The window split in HIT_CELL_SIZE squares, each listing the visible
+ * widgets over it in drawing order: cell c's are entries[starts[c]] up to
+ * entries[starts[c + 1]]. Rebuilt, when dirty, before handling events.
+ */
+static struct {
+  Index* starts;
+  Index* entries;
+  int columns, rows;
+  int totalCells;
+  Index totalEntries;
+  bool dirty;
+} _hits;
+
+static Index
+_getParentIndex(Index index)
+{
+  Id parent = _elements.elements[index].parent;
+  return parent == VOID_ID ? VOID_INDEX : Pool_GetIndex(&_elements.pool, parent);
+}
+
+static void
+_relayout(Index index)
+{
+  _elements.elements[index].relayout = true;
+  _elements.dirty = true;
+  _hits.dirty = true;
+}
+
+/* Widgets sized after their source are laid out again when it changes. */
+static void
+_resize(Index index)
+{
+  Element* element = &_elements.elements[index];
+  if (element->w == WIDGET_AUTO || element->h == WIDGET_AUTO) {
+    _relayout(index);
+  } else {
+    _elements.dirty = true;
+  }
+}
+
+/* Deletes the widget at index with its subtree, keeping the others in order. */
+static void
+_delete(Index index)
+{
+  Index size = _elements.elements[index].subtreeSize;
+  for (Index i = _getParentIndex(index); i != VOID_INDEX; i = _getParentIndex(i)) {
+    _elements.elements[i].subtreeSize -= size;
+  }
+
+  for (Index i = index + size; i-- > index; ) {
+    SDL_DestroyTexture(_elements.elements[i].texture);
+    Pool_Move(&_elements.pool, i, _elements.pool.total - 1);
+    Pool_DeleteAt(&_elements.pool, _elements.pool.total - 1);
+  }
+  _elements.dirty = true;
+  _hits.dirty = true;
+}
+
 Id 
 Widget_Create(Id parent)
 {
   Index index;
-  Id id;
-  GET_NEXT_ID(_elements, id, index, MAX_Widget_ELEMENTS);
+  Id id = Pool_Create(&_elements.pool, &index);
+  Element* element = &_elements.elements[index];
+  memset(element, 0, sizeof(Element));
+  element->scope = _elements.scope;
+  element->parent = parent;
+  element->subtreeSize = 1;
+  _relayout(index);
 
   if (parent != VOID_ID) {
-    Index parentIdx;
-    GET_INDEX_FROM_ID(_elements, parent, parentIdx);
-    _elements.elements[index].parent = parent;
-  } else {
-    _elements.elements[index].parent = VOID_INDEX;
+    assert(Pool_Has(&_elements.pool, parent));
+    Index parentIndex = Pool_GetIndex(&_elements.pool, parent);
+    Pool_Move(
+      &_elements.pool, 
+      index, 
+      parentIndex + _elements.elements[parentIndex].subtreeSize
+    );
+    for (Index i = parentIndex; i != VOID_INDEX; i = _getParentIndex(i)) {
+      _elements.elements[i].subtreeSize++;
+    }
   }
 
-
   return id;
 }
 
+void
+Widget_Delete(Id id)
+{
+  _delete(Pool_GetIndex(&_elements.pool, id));
+}
+
 void 
 Widget_AddEventListener(Id el, Widget_Events e, Widget_OnHandlerFunc handler)
 {
-
+  Element* element = &_elements.elements[Pool_GetIndex(&_elements.pool, el)];
+  for (Widget_Events i = 0; i < Widget_All; i++) {
+    if (e == Widget_All || e == i) {
+      element->handlers[i] = handler;
+    }
+  }
 }
 
 void 
 Widget_RemoveEventListener(Id el, Widget_Events e, Widget_OnHandlerFunc handler)
 {
+  Element* element = &_elements.elements[Pool_GetIndex(&_elements.pool, el)];
+  for (Widget_Events i = 0; i < Widget_All; i++) {
+    if ((e == Widget_All || e == i) && element->handlers[i] == handler) {
+      element->handlers[i] = NULL;
+    }
+  }
+}
 
+static void
+_layoutElement(Index i, int windowWidth, int windowHeight)
+{
+  Element element = _elements.elements[i];
+  SDL_Rect dest = {0};
+  SDL_Rect parentDest = {0};
+
+  Index parent = _getParentIndex(i);
+  if (parent == VOID_INDEX) {
+    parentDest.w = windowWidth;
+    parentDest.h = windowHeight;
+  } else {
+    parentDest = _elements.elements[parent].dest;
+  }
+
+  dest.x = element.x;
+  if (element.unitInPercentFlags & UnitInPercentFlags_X) {
+    dest.x *= parentDest.w / 100;
+  }
+  dest.x += parentDest.x;
+
+  dest.y = element.y;
+  if (element.unitInPercentFlags & UnitInPercentFlags_Y) {
+    dest.y *= parentDest.w / 100;
+  }
+  dest.y += parentDest.y;
+
+  dest.w = element.w;
+  if (element.w == WIDGET_AUTO) {
+    dest.w = element.src.w;
+  } else if (element.unitInPercentFlags & UnitInPercentFlags_Width) {
+    dest.w *= parentDest.w / 100;
+  }
+
+  dest.h = element.h;
+  if (element.h == WIDGET_AUTO) {
+    dest.h = element.src.h;
+  } else if (element.unitInPercentFlags & UnitInPercentFlags_Height) {
+    dest.h *= parentDest.h / 100;
+  }
+
+  switch (element.horizontalAlignment) {
+      case Widget_HorizontalAlignRight:
+        dest.x = parentDest.x + parentDest.w - dest.w;
+        break;
+      case Widget_HorizontalAlignCenter:
+        dest.x = parentDest.x + parentDest.w / 2 - dest.w / 2;
+        break;
+      default: break;
+  }
+
+  switch (element.verticalAlignment) {
+      case Widget_VerticalAlignBottom:
+        dest.y = parentDest.y + parentDest.h - dest.h;
+        break;
+      case Widget_VerticalAlignCenter:
+        dest.y = parentDest.y + parentDest.h / 2 - dest.h / 2;
+        break;
+      default: break;
+  }
+
+  _elements.elements[i].dest = dest;
 }
 
-void 
-Widget_Render()
+static void
+_layout(int windowWidth, int windowHeight)
 {
-  for (Index i = 0; i < _elements.total; i++) {
-    Element element = _elements.elements[i];
-    SDL_Rect dest = {0};
-    SDL_Rect parentDest = {0};
+  if (windowWidth != _elements.layoutWidth || windowHeight != _elements.layoutHeight) {
+    _elements.layoutWidth = windowWidth;
+    _elements.layoutHeight = windowHeight;
+    for (Index i = 0; i < _elements.pool.total; i++) {
+      if (_elements.elements[i].parent == VOID_ID) {
+        _relayout(i);
+      }
+    }
+  }
 
-    if (element.parent == VOID_INDEX) {
-      Graphic_QueryWindowSize(&parentDest.w, &parentDest.h);
-    } else {
-      parentDest = _elements.elements[element.parent].dest;
+  for (Index i = 0; i < _elements.pool.total; ) {
+    if (!_elements.elements[i].relayout) {
+      i++;
+      continue;
     }
 
-    dest.x = element.x;
-    if (element.unitInPercentFlags & UnitInPercentFlags_X) {
-      dest.x *= parentDest.w / 100;
+    // Children are placed relative to their parent, so its subtree follows.
+    Index end = i + _elements.elements[i].subtreeSize;
+    for (; i < end; i++) {
+      _layoutElement(i, windowWidth, windowHeight);
+      _elements.elements[i].relayout = false;
     }
-    dest.x += parentDest.x;
+  }
+}
 
-    dest.y = element.y;
-    if (element.unitInPercentFlags & UnitInPercentFlags_Y) {
-      dest.y *= parentDest.w / 100;
+static void
+_queryCells(SDL_Rect dest, int* x0, int* y0, int* x1, int* y1)
+{
+  *x0 = SDL_max(dest.x, 0) / HIT_CELL_SIZE;
+  *y0 = SDL_max(dest.y, 0) / HIT_CELL_SIZE;
+  *x1 = SDL_min((dest.x + dest.w - 1) / HIT_CELL_SIZE, _hits.columns - 1);
+  *y1 = SDL_min((dest.y + dest.h - 1) / HIT_CELL_SIZE, _hits.rows - 1);
+}
+
+/* Counts the entries of each cell when entries is NULL, or writes them. */
+static void
+_fillCells(Index* entries)
+{
+  for (Index i = 0; i < _elements.pool.total; i++) {
+    Element* el = &_elements.elements[i];
+    if (el->hidden) {
+      i += el->subtreeSize - 1;
+      continue;
+    }
+    if (el->dest.w <= 0 || el->dest.h <= 0) {
+      continue;
     }
-    dest.y += parentDest.y;
 
-    dest.w = element.w;
-    if (element.unitInPercentFlags & UnitInPercentFlags_Width) {
-      dest.w *= parentDest.w / 100;
+    int x0, y0, x1, y1;
+    _queryCells(el->dest, &x0, &y0, &x1, &y1);
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        int cell = y * _hits.columns + x;
+        if (entries) {
+          entries[_hits.starts[cell]++] = i;
+        } else {
+          _hits.starts[cell + 1]++;
+        }
+      }
     }
+  }
+}
 
-    dest.h = element.h;
-    if (element.unitInPercentFlags & UnitInPercentFlags_Height) {
-      dest.h *= parentDest.h / 100;
+static void
+_buildHits()
+{
+  _hits.dirty = false;
+  _hits.columns = (_elements.layoutWidth + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE;
+  _hits.rows = (_elements.layoutHeight + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE;
+  int totalCells = _hits.columns * _hits.rows;
+  if (totalCells > _hits.totalCells) {
+    _hits.totalCells = totalCells;
+    _hits.starts = realloc(_hits.starts, (totalCells + 1) * sizeof(Index));
+    if (_hits.starts == NULL) {
+      fprintf(stderr, "Couldn't allocate %d widget hit cells!\n", totalCells);
+      exit(EXIT_FAILURE);
     }
+  }
+  memset(_hits.starts, 0, (totalCells + 1) * sizeof(Index));
 
-    switch (element.horizontalAlignment) {
-        case Widget_HorizontalAlignRight:
-          dest.x = parentDest.x + parentDest.w - dest.w;
-          break;
-        case Widget_HorizontalAlignCenter:
-          dest.x = (parentDest.x + parentDest.w) / 2 - dest.w / 2;
-          break;
-        default: break;
+  _fillCells(NULL);
+  for (int cell = 0; cell < totalCells; cell++) {
+    _hits.starts[cell + 1] += _hits.starts[cell];
+  }
+  Index totalEntries = _hits.starts[totalCells];
+  if (totalEntries > _hits.totalEntries) {
+    _hits.totalEntries = totalEntries;
+    _hits.entries = realloc(_hits.entries, totalEntries * sizeof(Index));
+    if (_hits.entries == NULL) {
+      fprintf(stderr, "Couldn't allocate %u widget hit entries!\n", totalEntries);
+      exit(EXIT_FAILURE);
     }
+  }
 
-    switch (element.verticalAlignment) {
-        case Widget_VerticalAlignBottom:
-          dest.y = parentDest.y + parentDest.h - dest.h;
-          break;
-        case Widget_VerticalAlignCenter:
-          dest.y = (parentDest.y + parentDest.h) / 2 - dest.h / 2;
-          break;
-        default: break;
+  // Filling moves each cell's start to the next one's, so shift them back.
+  _fillCells(_hits.entries);
+  for (int cell = totalCells; cell > 0; cell--) {
+    _hits.starts[cell] = _hits.starts[cell - 1];
+  }
+  _hits.starts[0] = 0;
+}
+
+/* Returns the index of the widget drawn last at x, y, or VOID_INDEX. */
+static Index
+_hitTest(int x, int y)
+{
+  if (x < 0 || y < 0) {
+    return VOID_INDEX;
+  }
+  int column = x / HIT_CELL_SIZE, row = y / HIT_CELL_SIZE;
+  if (column >= _hits.columns || row >= _hits.rows) {
+    return VOID_INDEX;
+  }
+
+  int cell = row * _hits.columns + column;
+  for (Index e = _hits.starts[cell + 1]; e-- > _hits.starts[cell]; ) {
+    SDL_Rect dest = _elements.elements[_hits.entries[e]].dest;
+    if (x >= dest.x && x < dest.x + dest.w && y >= dest.y && y < dest.y + dest.h) {
+      return _hits.entries[e];
     }
+  }
+  return VOID_INDEX;
+}
 
-    _elements.elements[i].dest = dest;
+/* Returns the widget at index or its closest ancestor listening to e. */
+static Id
+_findListener(Index index, Widget_Events e)
+{
+  for (Index i = index; i != VOID_INDEX; i = _getParentIndex(i)) {
+    if (_elements.elements[i].handlers[e]) {
+      return _elements.pool.ids[i];
+    }
+  }
+  return VOID_ID;
+}
+
+/* Handlers may delete widgets, so id is checked again before each one. */
+static void
+_fire(Id id, Widget_Events e)
+{
+  if (id == VOID_ID || !Pool_Has(&_elements.pool, id)) {
+    return;
+  }
+  Widget_OnHandlerFunc handler
+    = _elements.elements[Pool_GetIndex(&_elements.pool, id)].handlers[e];
+  if (handler) {
+    handler(id, e);
   }
+}
 
-  for (Index i = 0; i < _elements.total; i++) {
+void
+Widget_HandleEvents()
+{
+  int w, h;
+  Graphic_QueryWindowSize(&w, &h);
+  // A resize polled with the inputs moves widgets before they are rendered.
+  if (_elements.dirty || w != _elements.layoutWidth || h != _elements.layoutHeight) {
+    _layout(w, h);
+  }
+  if (_hits.dirty) {
+    _buildHits();
+  }
+
+  int x, y;
+  Input_QueryMousePosition(&x, &y);
+  Index target = _hitTest(x, y);
+  Id focused = _findListener(target, Widget_OnFocus);
+  Id clicked = Input_IsMouseButtonReleased(LeftMouseButton)
+    ? _findListener(target, Widget_OnClick)
+    : VOID_ID;
+
+  if (focused != _elements.focused) {
+    Id blurred = _elements.focused;
+    _elements.focused = focused;
+    _fire(blurred, Widget_OnFocus);
+    _fire(focused, Widget_OnFocus);
+  }
+  _fire(clicked, Widget_OnClick);
+}
+
+bool
+Widget_IsFocused(Id id)
+{
+  return id == _elements.focused;
+}
+
+Index
+Widget_GetTotal()
+{
+  return _elements.pool.total;
+}
+
+/* Returns how many widgets were drawn. */
+static int
+_draw()
+{
+  int drawn = 0;
+  for (Index i = 0; i < _elements.pool.total; i++) {
     Element el = _elements.elements[i];
+    if (el.hidden) {
+      i += el.subtreeSize - 1;
+      continue;
+    }
 
-    Graphic_FillRect(el.dest, el.backgroundColor);
+    // Fully transparent backgrounds have nothing to fill.
+    if (el.backgroundColor & 0xFF) {
+      Graphic_FillRect(el.dest, el.backgroundColor);
+    }
 
     if (el.texture) {
       Graphic_RenderCopy(el.texture, &el.src, &el.dest);
     }
+    drawn++;
+  }
+  return drawn;
+}
+
+void 
+Widget_Render()
+{
+  int w, h;
+  Graphic_QueryWindowSize(&w, &h);
+  if (w != _elements.targetWidth || h != _elements.targetHeight) {
+    SDL_DestroyTexture(_elements.target);
+    _elements.target = Graphic_CreateTargetSDLTexture(w, h);
+    _elements.targetWidth = w;
+    _elements.targetHeight = h;
+    _elements.dirty = true;
+  }
+
+  if (_elements.dirty) {
+    _layout(w, h);
+  }
+
+  // Without a target, widgets are drawn every frame as they used to.
+  if (_elements.target == NULL) {
+    _elements.dirty = false;
+    _draw();
+    return;
+  }
+
+  if (_elements.dirty) {
+    _elements.dirty = false;
+    Graphic_BeginTarget(_elements.target);
+    _elements.totalDrawn = _draw();
+    Graphic_EndTarget();
+  }
+
+  if (_elements.totalDrawn > 0) {
+    SDL_Rect dest = { 0, 0, w, h };
+    Graphic_RenderCopy(_elements.target, NULL, &dest);
   }
 }
 
 void
 Widget_Init()
 {
-  INIT_STRUCT_FOR_DOD_FREE_LIST(_elements, MAX_Widget_ELEMENTS);
+  Pool_Init(&_elements.pool, INITIAL_Widget_ELEMENTS, MAX_Widget_ELEMENTS);
+  POOL_ADD_COLUMN(&_elements.pool, _elements.elements);
+  _elements.focused = VOID_ID;
   /*
   _elements.total = 1;
   _elements.elements[Widget_ROOT].backgroundColor = 0xFF00FFFF;
@@ -158,28 +521,34 @@ Widget_SetAligments(
     Widget_HorizontalAlignment horizontalAlignment, 
     Widget_VerticalAlignment verticalAlignment) 
 {
-  Index idx;
-  GET_INDEX_FROM_ID(_elements, id, idx);
+  Index idx = Pool_GetIndex(&_elements.pool, id);
 
   _elements.elements[idx].horizontalAlignment = horizontalAlignment;
   _elements.elements[idx].verticalAlignment = verticalAlignment;
+  _relayout(idx);
 }
 
 void 
-Widget_SetText(Id id, const char * const text)
+Widget_SetText(Id id, const char * const text, SDL_Color color)
 {
-  Index idx;
-  GET_INDEX_FROM_ID(_elements, id, idx);
-  SDL_Color color = {0xFF, 0xFF, 0xFF, 0xFF};
+  Index idx = Pool_GetIndex(&_elements.pool, id);
+  SDL_DestroyTexture(_elements.elements[idx].texture);
   _elements.elements[idx].texture = Graphic_CreateTextSDLTexture(
-      text, color, NULL, NULL);
+      text, 
+      color, 
+      (unsigned int*) &_elements.elements[idx].src.w, 
+      (unsigned int*) &_elements.elements[idx].src.h
+  );
+  _elements.elements[idx].src.x = 0;
+  _elements.elements[idx].src.y = 0;
+  _resize(idx);
 }
 
 void 
 Widget_SetImage(Id id, const char * const image)
 {
-  Index idx;
-  GET_INDEX_FROM_ID(_elements, id, idx);
+  Index idx = Pool_GetIndex(&_elements.pool, id);
+  SDL_DestroyTexture(_elements.elements[idx].texture);
   _elements.elements[idx].texture = Graphic_CreateSDLTexture(image);
   _elements.elements[idx].src.x = 0;
   _elements.elements[idx].src.y = 0;
@@ -189,6 +558,7 @@ Widget_SetImage(Id id, const char * const image)
       &_elements.elements[idx].src.w,
       &_elements.elements[idx].src.h
   );
+  _resize(idx);
 }
 
 void 
@@ -200,20 +570,51 @@ Widget_SetPosition(
     double h, 
     UnitInPercentFlags flags
 ) {
-  Index idx;
-  GET_INDEX_FROM_ID(_elements, id, idx);
+  Index idx = Pool_GetIndex(&_elements.pool, id);
 
   _elements.elements[idx].x = x;
   _elements.elements[idx].y = y;
   _elements.elements[idx].w = w;
   _elements.elements[idx].h = h;
   _elements.elements[idx].unitInPercentFlags = flags;
+  _relayout(idx);
 }
 
 void 
 Widget_SetSrc(Id id, SDL_Rect src)
 {
-  Index idx;
-  GET_INDEX_FROM_ID(_elements, id, idx);
+  Index idx = Pool_GetIndex(&_elements.pool, id);
   _elements.elements[idx].src = src;
+  _resize(idx);
+}
+
+void
+Widget_SetHidden(Id id, bool hidden)
+{
+  Index idx = Pool_GetIndex(&_elements.pool, id);
+  if (_elements.elements[idx].hidden != hidden) {
+    _elements.elements[idx].hidden = hidden;
+    _elements.dirty = true;
+    _hits.dirty = true;
+  }
+}
+
+void
+Widget_OpenScope()
+{
+  _elements.scope++;
+}
+
+void
+Widget_CloseScope()
+{
+  assert(_elements.scope > 0);
+  // Children are never in a scope outside their parent's, so each subtree
+  // deleted is the closing scope's; it only moves the widgets after it.
+  for (Index i = _elements.pool.total; i-- > 0; ) {
+    if (_elements.elements[i].scope == _elements.scope) {
+      _delete(i);
+    }
+  }
+  _elements.scope--;
 }
@@ -0,0 +1,165 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pack.h"
+
+/*
+ * Decodes images into the asset pack read by Graphic_OpenPack:
+ *
+ *   bin/asset-packer assets.pack sprite-sheet2.bmp background.png
+ *
+ * Each image is named after its path as given, which must be the name the
+ * game loads it by. Magenta pixels become transparent, as they would with
+ * the colour key Graphic_LoadTexture sets, and every colour is premultiplied
+ * by its alpha.
+ */
+
+#define PACK_FORMAT SDL_PIXELFORMAT_ARGB8888
+
+static size_t
+_align(size_t offset, size_t alignment)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+static Uint8
+_premultiply(Uint8 color, Uint8 alpha)
+{
+  return (color * alpha + 127) / 255;
+}
+
+static SDL_Surface*
+_decode(const char* filename)
+{
+  SDL_Surface* image = IMG_Load(filename);
+  if (image == NULL) {
+    fprintf(stderr, "Couldn't load %s! SDL_Error: %s\n", filename, IMG_GetError());
+    exit(EXIT_FAILURE);
+  }
+  SDL_Surface* surface = SDL_ConvertSurfaceFormat(image, PACK_FORMAT, 0);
+  SDL_FreeSurface(image);
+  if (surface == NULL) {
+    fprintf(stderr, "Couldn't convert %s! SDL_Error: %s\n", filename, SDL_GetError());
+    exit(EXIT_FAILURE);
+  }
+
+  SDL_LockSurface(surface);
+  for (int y = 0; y < surface->h; y++) {
+    Uint32* row = (Uint32*) ((Uint8*) surface->pixels + y * surface->pitch);
+    for (int x = 0; x < surface->w; x++) {
+      Uint8 r, g, b, a;
+      SDL_GetRGBA(row[x], surface->format, &r, &g, &b, &a);
+      if (r == 0xff && g == 0 && b == 0xff) {
+        a = 0;
+      }
+      row[x] = SDL_MapRGBA(
+        surface->format,
+        _premultiply(r, a),
+        _premultiply(g, a),
+        _premultiply(b, a),
+        a
+      );
+    }
+  }
+  SDL_UnlockSurface(surface);
+
+  return surface;
+}
+
+static void
+_pad(FILE* output, size_t offset)
+{
+  static const char zeros[PACK_PAGE];
+  long position = ftell(output);
+  if (position >= 0 && (size_t) position < offset) {
+    fwrite(zeros, 1, offset - position, output);
+  }
+}
+
+static void
+_write(FILE* output, char** filenames, int totalImages)
+{
+  SDL_Surface** surfaces = calloc(totalImages, sizeof(*surfaces));
+  Pack_Image* images = calloc(totalImages, sizeof(*images));
+  if (surfaces == NULL || images == NULL) {
+    fprintf(stderr, "Couldn't allocate %d images!\n", totalImages);
+    exit(EXIT_FAILURE);
+  }
+
+  Pack_Header header = {0};
+  memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+  header.version = PACK_VERSION;
+  header.format = PACK_FORMAT;
+  header.totalImages = totalImages;
+  header.imagesOffset = _align(sizeof(header), 4);
+
+  size_t offset = header.imagesOffset + totalImages * sizeof(*images);
+  for (int i = 0; i < totalImages; i++) {
+    if (strlen(filenames[i]) >= PACK_NAME) {
+      fprintf(stderr, "Image name %s is too long!\n", filenames[i]);
+      exit(EXIT_FAILURE);
+    }
+    surfaces[i] = _decode(filenames[i]);
+
+    Pack_Image* image = &images[i];
+    strcpy(image->name, filenames[i]);
+    image->w = surfaces[i]->w;
+    image->h = surfaces[i]->h;
+    image->pitch = surfaces[i]->pitch;
+    offset = _align(offset, PACK_PAGE);
+    if (offset > UINT32_MAX - (size_t) image->h * image->pitch) {
+      fprintf(stderr, "Asset pack is too big!\n");
+      exit(EXIT_FAILURE);
+    }
+    image->pixelsOffset = offset;
+    offset += (size_t) image->h * image->pitch;
+  }
+
+  _pad(output, 0);
+  fwrite(&header, sizeof(header), 1, output);
+  _pad(output, header.imagesOffset);
+  fwrite(images, sizeof(*images), totalImages, output);
+  for (int i = 0; i < totalImages; i++) {
+    _pad(output, images[i].pixelsOffset);
+    fwrite(surfaces[i]->pixels, images[i].pitch, images[i].h, output);
+    SDL_FreeSurface(surfaces[i]);
+  }
+
+  free(images);
+  free(surfaces);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s OUTPUT.pack IMAGE...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // The pack is written straight from memory and is little-endian.
+  uint16_t one = 1;
+  if (*(unsigned char*) &one != 1) {
+    fprintf(stderr, "%s only runs on little-endian machines!\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  FILE* output = fopen(argv[1], "wb");
+  if (output == NULL) {
+    fprintf(stderr, "Couldn't create %s!\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  _write(output, argv + 2, argc - 2);
+  if (fclose(output) != 0) {
+    fprintf(stderr, "Couldn't write %s!\n", argv[1]);
+    remove(argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
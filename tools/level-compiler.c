@@ -0,0 +1,581 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game-types.h"
+#include "level.h"
+
+/*
+ * Compiles a text level description into the binary format read by
+ * Level_Open:
+ *
+ *   bin/level-compiler levels/first-level.txt levels/first-level.lvl
+ *
+ * The description is a list of directives, one per line, with # starting a
+ * comment. Coordinates are in tiles and z is in pixels.
+ *
+ *   size W H                map size, must come first
+ *   lane NAME N             coordinate of a lane, every lane must be set
+ *   fill TILE               set every ground tile
+ *   rect TILE X Y W H       set a rectangle of ground tiles
+ *   legend C TILE           character used for TILE in ground blocks
+ *   ground X Y              rows of legend characters until "end", with
+ *                           their first character at (X, Y)
+ *   cell TILE X Y           set an object tile
+ *   spawn PATH              customer walking PATH when the level starts
+ *   object TILE X Y Z       game object
+ *   prefab NAME             group of objects until "end", relative to the
+ *                           position the prefab is placed at
+ *   place NAME X Y          instance of a prefab
+ *
+ * Customers are created first, then objects and then prefab instances, each
+ * in the order they appear in.
+ */
+
+#define MAX_LINE 1024
+#define MAX_NAME 64
+#define NO_CELLS UINT32_MAX
+
+typedef struct {
+  char name[MAX_NAME];
+  Level_Prefab prefab;
+} Prefab;
+
+static const char* const _tileNames[] = { GAME_TILES(GAME_TYPES_NAME) };
+static const char* const _pathNames[] = { GAME_PATHS(GAME_TYPES_NAME) };
+static const char* const _laneNames[] = { GAME_LANES(GAME_TYPES_NAME) };
+
+static const char* _filename;
+static int _line;
+
+static int _width, _height;
+static uint16_t* _ground;
+static uint16_t* _objects;
+static int32_t _lanes[TotalLanes];
+static bool _hasLane[TotalLanes];
+static GameTiles _legend[256];
+
+static uint32_t* _spawns;
+static uint32_t _totalSpawns;
+static Level_Object* _levelObjects;
+static uint32_t _totalLevelObjects;
+static Prefab* _prefabs;
+static uint32_t _totalPrefabs;
+static Level_Object* _prefabObjects;
+static uint32_t _totalPrefabObjects;
+static Level_Instance* _instances;
+static uint32_t _totalInstances;
+
+static void
+_fail(const char* message, const char* detail)
+{
+  fprintf(stderr, "%s:%d: %s%s%s\n", _filename, _line, message,
+      detail ? ": " : "", detail ? detail : "");
+  exit(EXIT_FAILURE);
+}
+
+static void*
+_grow(void* data, uint32_t count, size_t size)
+{
+  // Grow by powers of two, so appends stay amortized O(1).
+  if (count & (count - 1)) {
+    return data;
+  }
+  data = realloc(data, (count ? count * 2 : 1) * size);
+  if (data == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  return data;
+}
+
+static int
+_findName(const char* const* names, int total, const char* name)
+{
+  for (int i = 0; i < total; i++) {
+    if (!strcmp(names[i], name)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static GameTiles
+_parseTile(const char* name)
+{
+  int tile = _findName(_tileNames, TotalGameTiles, name);
+  if (tile < 0) {
+    _fail("unknown tile", name);
+  }
+  return tile;
+}
+
+static void
+_checkSize()
+{
+  if (_ground == NULL) {
+    _fail("size must be set first", NULL);
+  }
+}
+
+static void
+_checkPosition(int x, int y)
+{
+  if (x < 0 || y < 0 || x >= _width || y >= _height) {
+    _fail("position out of the map", NULL);
+  }
+}
+
+static void
+_parseSize(const char* arguments)
+{
+  if (_ground) {
+    _fail("size set twice", NULL);
+  }
+  if (sscanf(arguments, "%d %d", &_width, &_height) != 2) {
+    _fail("expected: size W H", NULL);
+  }
+  if (
+      _width <= 0 ||
+      _height <= 0 ||
+      _width > 0xFFFF * LEVEL_CHUNK_SIZE ||
+      _height > 0xFFFF * LEVEL_CHUNK_SIZE
+  ) {
+    _fail("invalid map size", NULL);
+  }
+
+  _ground = calloc((size_t) _width * _height, sizeof(uint16_t));
+  _objects = calloc((size_t) _width * _height, sizeof(uint16_t));
+  if (_ground == NULL || _objects == NULL) {
+    _fail("map is too big", NULL);
+  }
+}
+
+static void
+_parseLane(const char* arguments)
+{
+  char name[MAX_NAME];
+  int position;
+  if (sscanf(arguments, "%63s %d", name, &position) != 2) {
+    _fail("expected: lane NAME N", NULL);
+  }
+  int lane = _findName(_laneNames, TotalLanes, name);
+  if (lane < 0) {
+    _fail("unknown lane", name);
+  }
+  _lanes[lane] = position;
+  _hasLane[lane] = true;
+}
+
+static void
+_parseRect(const char* arguments)
+{
+  char name[MAX_NAME];
+  int x, y, w, h;
+  _checkSize();
+  if (sscanf(arguments, "%63s %d %d %d %d", name, &x, &y, &w, &h) != 5) {
+    _fail("expected: rect TILE X Y W H", NULL);
+  }
+  GameTiles tile = _parseTile(name);
+  if (w <= 0 || h <= 0) {
+    _fail("empty rect", NULL);
+  }
+  _checkPosition(x, y);
+  _checkPosition(x + w - 1, y + h - 1);
+
+  for (int j = y; j < y + h; j++) {
+    for (int i = x; i < x + w; i++) {
+      _ground[(size_t) j * _width + i] = tile;
+    }
+  }
+}
+
+static void
+_parseFill(const char* arguments)
+{
+  char name[MAX_NAME];
+  _checkSize();
+  if (sscanf(arguments, "%63s", name) != 1) {
+    _fail("expected: fill TILE", NULL);
+  }
+  GameTiles tile = _parseTile(name);
+  for (size_t i = 0; i < (size_t) _width * _height; i++) {
+    _ground[i] = tile;
+  }
+}
+
+static void
+_parseLegend(const char* arguments)
+{
+  char symbol;
+  char name[MAX_NAME];
+  if (sscanf(arguments, " %c %63s", &symbol, name) != 2) {
+    _fail("expected: legend C TILE", NULL);
+  }
+  _legend[(unsigned char) symbol] = _parseTile(name);
+}
+
+static void
+_parseGroundRow(const char* row, int x, int y)
+{
+  size_t length = strcspn(row, "\r\n");
+  if (length) {
+    _checkPosition(x, y);
+    _checkPosition(x + length - 1, y);
+  }
+  for (size_t i = 0; i < length; i++) {
+    GameTiles tile = _legend[(unsigned char) row[i]];
+    if (tile == GameTile_Empty) {
+      char symbol[2] = { row[i], '\0' };
+      _fail("character without a legend", symbol);
+    }
+    _ground[(size_t) y * _width + x + i] = tile;
+  }
+}
+
+static void
+_parseCell(const char* arguments)
+{
+  char name[MAX_NAME];
+  int x, y;
+  _checkSize();
+  if (sscanf(arguments, "%63s %d %d", name, &x, &y) != 3) {
+    _fail("expected: cell TILE X Y", NULL);
+  }
+  GameTiles tile = _parseTile(name);
+  _checkPosition(x, y);
+  _objects[(size_t) y * _width + x] = tile;
+}
+
+static void
+_parseSpawn(const char* arguments)
+{
+  char name[MAX_NAME];
+  if (sscanf(arguments, "%63s", name) != 1) {
+    _fail("expected: spawn PATH", NULL);
+  }
+  int path = _findName(_pathNames, TotalPaths, name);
+  if (path <= NoPath) {
+    _fail("unknown path", name);
+  }
+  _spawns = _grow(_spawns, _totalSpawns, sizeof(*_spawns));
+  _spawns[_totalSpawns++] = path;
+}
+
+static Level_Object
+_parseObject(const char* arguments)
+{
+  char name[MAX_NAME];
+  Level_Object object;
+  if (
+      sscanf(
+        arguments,
+        "%63s %f %f %f",
+        name,
+        &object.x,
+        &object.y,
+        &object.z
+      ) != 4
+  ) {
+    _fail("expected: object TILE X Y Z", NULL);
+  }
+  object.tile = _parseTile(name);
+  return object;
+}
+
+static Prefab*
+_findPrefab(const char* name)
+{
+  for (uint32_t i = 0; i < _totalPrefabs; i++) {
+    if (!strcmp(_prefabs[i].name, name)) {
+      return &_prefabs[i];
+    }
+  }
+  return NULL;
+}
+
+static Prefab*
+_parsePrefab(const char* arguments)
+{
+  char name[MAX_NAME];
+  if (sscanf(arguments, "%63s", name) != 1) {
+    _fail("expected: prefab NAME", NULL);
+  }
+  if (_findPrefab(name)) {
+    _fail("prefab defined twice", name);
+  }
+
+  _prefabs = _grow(_prefabs, _totalPrefabs, sizeof(*_prefabs));
+  Prefab* prefab = &_prefabs[_totalPrefabs++];
+  strcpy(prefab->name, name);
+  prefab->prefab.firstObject = _totalPrefabObjects;
+  prefab->prefab.totalObjects = 0;
+  return prefab;
+}
+
+static void
+_parsePlace(const char* arguments)
+{
+  char name[MAX_NAME];
+  int x, y;
+  if (sscanf(arguments, "%63s %d %d", name, &x, &y) != 3) {
+    _fail("expected: place NAME X Y", NULL);
+  }
+  Prefab* prefab = _findPrefab(name);
+  if (prefab == NULL) {
+    _fail("unknown prefab", name);
+  }
+
+  _instances = _grow(_instances, _totalInstances, sizeof(*_instances));
+  _instances[_totalInstances].prefab = prefab - _prefabs;
+  _instances[_totalInstances].x = x;
+  _instances[_totalInstances].y = y;
+  _totalInstances++;
+}
+
+static void
+_parse(FILE* file)
+{
+  char line[MAX_LINE];
+  Prefab* prefab = NULL;
+  bool inGround = false;
+  int groundX = 0, groundY = 0;
+
+  for (_line = 1; fgets(line, sizeof(line), file); _line++) {
+    if (inGround) {
+      if (!strncmp(line, "end", 3) && strspn(line + 3, " \t\r\n") == strlen(line + 3)) {
+        inGround = false;
+      } else {
+        _parseGroundRow(line, groundX, groundY++);
+      }
+      continue;
+    }
+
+    line[strcspn(line, "#")] = '\0';
+    char directive[MAX_NAME];
+    int length;
+    if (sscanf(line, "%63s%n", directive, &length) != 1) {
+      continue;
+    }
+    const char* arguments = line + length;
+
+    if (prefab) {
+      if (!strcmp(directive, "end")) {
+        prefab = NULL;
+      } else if (!strcmp(directive, "object")) {
+        _prefabObjects = _grow(
+            _prefabObjects,
+            _totalPrefabObjects,
+            sizeof(*_prefabObjects)
+        );
+        _prefabObjects[_totalPrefabObjects++] = _parseObject(arguments);
+        prefab->prefab.totalObjects++;
+      } else {
+        _fail("only objects can be in a prefab", directive);
+      }
+    } else if (!strcmp(directive, "size")) {
+      _parseSize(arguments);
+    } else if (!strcmp(directive, "lane")) {
+      _parseLane(arguments);
+    } else if (!strcmp(directive, "fill")) {
+      _parseFill(arguments);
+    } else if (!strcmp(directive, "rect")) {
+      _parseRect(arguments);
+    } else if (!strcmp(directive, "legend")) {
+      _parseLegend(arguments);
+    } else if (!strcmp(directive, "ground")) {
+      _checkSize();
+      if (sscanf(arguments, "%d %d", &groundX, &groundY) != 2) {
+        _fail("expected: ground X Y", NULL);
+      }
+      inGround = true;
+    } else if (!strcmp(directive, "cell")) {
+      _parseCell(arguments);
+    } else if (!strcmp(directive, "spawn")) {
+      _parseSpawn(arguments);
+    } else if (!strcmp(directive, "object")) {
+      _levelObjects = _grow(
+          _levelObjects,
+          _totalLevelObjects,
+          sizeof(*_levelObjects)
+      );
+      _levelObjects[_totalLevelObjects++] = _parseObject(arguments);
+    } else if (!strcmp(directive, "prefab")) {
+      prefab = _parsePrefab(arguments);
+    } else if (!strcmp(directive, "place")) {
+      _parsePlace(arguments);
+    } else {
+      _fail("unknown directive", directive);
+    }
+  }
+
+  if (inGround || prefab) {
+    _fail("missing end", NULL);
+  }
+  _checkSize();
+  for (int i = 0; i < TotalLanes; i++) {
+    if (!_hasLane[i]) {
+      _fail("missing lane", _laneNames[i]);
+    }
+  }
+}
+
+/*
+ * Copies chunk (cx, cy) of grid into cells and tells whether it has any
+ * tile set. Cells past the map's edge stay empty.
+ */
+static bool
+_copyChunk(const uint16_t* grid, int cx, int cy, uint16_t* cells)
+{
+  bool used = false;
+  memset(cells, 0, LEVEL_CHUNK_CELLS * sizeof(*cells));
+  for (int y = 0; y < LEVEL_CHUNK_SIZE; y++) {
+    for (int x = 0; x < LEVEL_CHUNK_SIZE; x++) {
+      int mapX = cx * LEVEL_CHUNK_SIZE + x;
+      int mapY = cy * LEVEL_CHUNK_SIZE + y;
+      if (mapX >= _width || mapY >= _height) {
+        continue;
+      }
+      cells[y * LEVEL_CHUNK_SIZE + x] = grid[(size_t) mapY * _width + mapX];
+      used |= cells[y * LEVEL_CHUNK_SIZE + x] != GameTile_Empty;
+    }
+  }
+  return used;
+}
+
+static void
+_write(FILE* file)
+{
+  int chunksWide = (_width + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+  int chunksHigh = (_height + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+  size_t maxChunks = (size_t) chunksWide * chunksHigh;
+  Level_Chunk* chunks = malloc(maxChunks * sizeof(*chunks));
+  uint16_t* cells = malloc(maxChunks * 2 * LEVEL_CHUNK_CELLS * sizeof(*cells));
+  if (chunks == NULL || cells == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  Level_Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, LEVEL_MAGIC, sizeof(header.magic));
+  header.version = LEVEL_VERSION;
+  header.width = _width;
+  header.height = _height;
+
+  uint32_t offset = sizeof(header);
+  header.totalLanes = TotalLanes;
+  header.lanesOffset = offset;
+  offset += TotalLanes * sizeof(*_lanes);
+  header.totalSpawns = _totalSpawns;
+  header.spawnsOffset = offset;
+  offset += _totalSpawns * sizeof(*_spawns);
+  header.totalObjects = _totalLevelObjects;
+  header.objectsOffset = offset;
+  offset += _totalLevelObjects * sizeof(*_levelObjects);
+  header.totalPrefabs = _totalPrefabs;
+  header.prefabsOffset = offset;
+  offset += _totalPrefabs * sizeof(Level_Prefab);
+  header.totalPrefabObjects = _totalPrefabObjects;
+  header.prefabObjectsOffset = offset;
+  offset += _totalPrefabObjects * sizeof(*_prefabObjects);
+  header.totalInstances = _totalInstances;
+  header.instancesOffset = offset;
+  offset += _totalInstances * sizeof(*_instances);
+
+  // Chunks hold cell indices until the chunk table size, and so the offset
+  // of the cells right after it, is known.
+  uint32_t totalChunks = 0;
+  size_t totalCells = 0;
+  for (int cy = 0; cy < chunksHigh; cy++) {
+    for (int cx = 0; cx < chunksWide; cx++) {
+      Level_Chunk* chunk = &chunks[totalChunks];
+      chunk->x = cx;
+      chunk->y = cy;
+      chunk->groundOffset = NO_CELLS;
+      chunk->objectOffset = NO_CELLS;
+      if (_copyChunk(_ground, cx, cy, &cells[totalCells])) {
+        chunk->groundOffset = totalCells;
+        totalCells += LEVEL_CHUNK_CELLS;
+      }
+      if (_copyChunk(_objects, cx, cy, &cells[totalCells])) {
+        chunk->objectOffset = totalCells;
+        totalCells += LEVEL_CHUNK_CELLS;
+      }
+      if (chunk->groundOffset != NO_CELLS || chunk->objectOffset != NO_CELLS) {
+        totalChunks++;
+      }
+    }
+  }
+
+  header.totalChunks = totalChunks;
+  header.chunksOffset = offset;
+  offset += totalChunks * sizeof(*chunks);
+  for (uint32_t i = 0; i < totalChunks; i++) {
+    chunks[i].groundOffset = chunks[i].groundOffset == NO_CELLS ?
+      0 : offset + chunks[i].groundOffset * sizeof(*cells);
+    chunks[i].objectOffset = chunks[i].objectOffset == NO_CELLS ?
+      0 : offset + chunks[i].objectOffset * sizeof(*cells);
+  }
+
+  if ((uint64_t) offset + totalCells * sizeof(*cells) > UINT32_MAX) {
+    fprintf(stderr, "Level is too big!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  fwrite(&header, sizeof(header), 1, file);
+  fwrite(_lanes, sizeof(*_lanes), TotalLanes, file);
+  fwrite(_spawns, sizeof(*_spawns), _totalSpawns, file);
+  fwrite(_levelObjects, sizeof(*_levelObjects), _totalLevelObjects, file);
+  for (uint32_t i = 0; i < _totalPrefabs; i++) {
+    fwrite(&_prefabs[i].prefab, sizeof(Level_Prefab), 1, file);
+  }
+  fwrite(_prefabObjects, sizeof(*_prefabObjects), _totalPrefabObjects, file);
+  fwrite(_instances, sizeof(*_instances), _totalInstances, file);
+  fwrite(chunks, sizeof(*chunks), totalChunks, file);
+  fwrite(cells, sizeof(*cells), totalCells, file);
+
+  free(chunks);
+  free(cells);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s INPUT.txt OUTPUT.lvl\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // The level is written straight from memory and is little-endian.
+  uint16_t one = 1;
+  if (*(unsigned char*) &one != 1) {
+    fprintf(stderr, "%s only runs on little-endian machines!\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  _filename = argv[1];
+  FILE* input = fopen(argv[1], "r");
+  if (input == NULL) {
+    fprintf(stderr, "Couldn't open %s!\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  _parse(input);
+  fclose(input);
+
+  FILE* output = fopen(argv[2], "wb");
+  if (output == NULL) {
+    fprintf(stderr, "Couldn't create %s!\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+  _write(output);
+  if (fclose(output) != 0) {
+    fprintf(stderr, "Couldn't write %s!\n", argv[2]);
+    remove(argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}